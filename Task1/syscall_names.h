@@ -0,0 +1,102 @@
+// x86-64 system call names, indexed by syscall number
+// covers the stable range 0-334 (up to rseq); newer calls print as syscall_N
+
+#ifndef SYSCALL_NAMES_H
+#define SYSCALL_NAMES_H
+
+#include <asm/unistd_64.h>
+
+#define SYSCALL(name) [__NR_##name] = #name,
+
+static const char *syscall_names[] = {
+    SYSCALL(read) SYSCALL(write) SYSCALL(open) SYSCALL(close) SYSCALL(stat)
+    SYSCALL(fstat) SYSCALL(lstat) SYSCALL(poll) SYSCALL(lseek) SYSCALL(mmap)
+    SYSCALL(mprotect) SYSCALL(munmap) SYSCALL(brk) SYSCALL(rt_sigaction)
+    SYSCALL(rt_sigprocmask) SYSCALL(rt_sigreturn) SYSCALL(ioctl) SYSCALL(pread64)
+    SYSCALL(pwrite64) SYSCALL(readv) SYSCALL(writev) SYSCALL(access) SYSCALL(pipe)
+    SYSCALL(select) SYSCALL(sched_yield) SYSCALL(mremap) SYSCALL(msync) SYSCALL(mincore)
+    SYSCALL(madvise) SYSCALL(shmget) SYSCALL(shmat) SYSCALL(shmctl) SYSCALL(dup)
+    SYSCALL(dup2) SYSCALL(pause) SYSCALL(nanosleep) SYSCALL(getitimer) SYSCALL(alarm)
+    SYSCALL(setitimer) SYSCALL(getpid) SYSCALL(sendfile) SYSCALL(socket)
+    SYSCALL(connect) SYSCALL(accept) SYSCALL(sendto) SYSCALL(recvfrom) SYSCALL(sendmsg)
+    SYSCALL(recvmsg) SYSCALL(shutdown) SYSCALL(bind) SYSCALL(listen)
+    SYSCALL(getsockname) SYSCALL(getpeername) SYSCALL(socketpair) SYSCALL(setsockopt)
+    SYSCALL(getsockopt) SYSCALL(clone) SYSCALL(fork) SYSCALL(vfork) SYSCALL(execve)
+    SYSCALL(exit) SYSCALL(wait4) SYSCALL(kill) SYSCALL(uname) SYSCALL(semget)
+    SYSCALL(semop) SYSCALL(semctl) SYSCALL(shmdt) SYSCALL(msgget) SYSCALL(msgsnd)
+    SYSCALL(msgrcv) SYSCALL(msgctl) SYSCALL(fcntl) SYSCALL(flock) SYSCALL(fsync)
+    SYSCALL(fdatasync) SYSCALL(truncate) SYSCALL(ftruncate) SYSCALL(getdents)
+    SYSCALL(getcwd) SYSCALL(chdir) SYSCALL(fchdir) SYSCALL(rename) SYSCALL(mkdir)
+    SYSCALL(rmdir) SYSCALL(creat) SYSCALL(link) SYSCALL(unlink) SYSCALL(symlink)
+    SYSCALL(readlink) SYSCALL(chmod) SYSCALL(fchmod) SYSCALL(chown) SYSCALL(fchown)
+    SYSCALL(lchown) SYSCALL(umask) SYSCALL(gettimeofday) SYSCALL(getrlimit)
+    SYSCALL(getrusage) SYSCALL(sysinfo) SYSCALL(times) SYSCALL(ptrace) SYSCALL(getuid)
+    SYSCALL(syslog) SYSCALL(getgid) SYSCALL(setuid) SYSCALL(setgid) SYSCALL(geteuid)
+    SYSCALL(getegid) SYSCALL(setpgid) SYSCALL(getppid) SYSCALL(getpgrp) SYSCALL(setsid)
+    SYSCALL(setreuid) SYSCALL(setregid) SYSCALL(getgroups) SYSCALL(setgroups)
+    SYSCALL(setresuid) SYSCALL(getresuid) SYSCALL(setresgid) SYSCALL(getresgid)
+    SYSCALL(getpgid) SYSCALL(setfsuid) SYSCALL(setfsgid) SYSCALL(getsid) SYSCALL(capget)
+    SYSCALL(capset) SYSCALL(rt_sigpending) SYSCALL(rt_sigtimedwait)
+    SYSCALL(rt_sigqueueinfo) SYSCALL(rt_sigsuspend) SYSCALL(sigaltstack) SYSCALL(utime)
+    SYSCALL(mknod) SYSCALL(uselib) SYSCALL(personality) SYSCALL(ustat) SYSCALL(statfs)
+    SYSCALL(fstatfs) SYSCALL(sysfs) SYSCALL(getpriority) SYSCALL(setpriority)
+    SYSCALL(sched_setparam) SYSCALL(sched_getparam) SYSCALL(sched_setscheduler)
+    SYSCALL(sched_getscheduler) SYSCALL(sched_get_priority_max)
+    SYSCALL(sched_get_priority_min) SYSCALL(sched_rr_get_interval) SYSCALL(mlock)
+    SYSCALL(munlock) SYSCALL(mlockall) SYSCALL(munlockall) SYSCALL(vhangup)
+    SYSCALL(modify_ldt) SYSCALL(pivot_root) SYSCALL(_sysctl) SYSCALL(prctl)
+    SYSCALL(arch_prctl) SYSCALL(adjtimex) SYSCALL(setrlimit) SYSCALL(chroot)
+    SYSCALL(sync) SYSCALL(acct) SYSCALL(settimeofday) SYSCALL(mount) SYSCALL(umount2)
+    SYSCALL(swapon) SYSCALL(swapoff) SYSCALL(reboot) SYSCALL(sethostname)
+    SYSCALL(setdomainname) SYSCALL(iopl) SYSCALL(ioperm) SYSCALL(create_module)
+    SYSCALL(init_module) SYSCALL(delete_module) SYSCALL(get_kernel_syms)
+    SYSCALL(query_module) SYSCALL(quotactl) SYSCALL(nfsservctl) SYSCALL(getpmsg)
+    SYSCALL(putpmsg) SYSCALL(afs_syscall) SYSCALL(tuxcall) SYSCALL(security)
+    SYSCALL(gettid) SYSCALL(readahead) SYSCALL(setxattr) SYSCALL(lsetxattr)
+    SYSCALL(fsetxattr) SYSCALL(getxattr) SYSCALL(lgetxattr) SYSCALL(fgetxattr)
+    SYSCALL(listxattr) SYSCALL(llistxattr) SYSCALL(flistxattr) SYSCALL(removexattr)
+    SYSCALL(lremovexattr) SYSCALL(fremovexattr) SYSCALL(tkill) SYSCALL(time)
+    SYSCALL(futex) SYSCALL(sched_setaffinity) SYSCALL(sched_getaffinity)
+    SYSCALL(set_thread_area) SYSCALL(io_setup) SYSCALL(io_destroy) SYSCALL(io_getevents)
+    SYSCALL(io_submit) SYSCALL(io_cancel) SYSCALL(get_thread_area)
+    SYSCALL(lookup_dcookie) SYSCALL(epoll_create) SYSCALL(epoll_ctl_old)
+    SYSCALL(epoll_wait_old) SYSCALL(remap_file_pages) SYSCALL(getdents64)
+    SYSCALL(set_tid_address) SYSCALL(restart_syscall) SYSCALL(semtimedop)
+    SYSCALL(fadvise64) SYSCALL(timer_create) SYSCALL(timer_settime)
+    SYSCALL(timer_gettime) SYSCALL(timer_getoverrun) SYSCALL(timer_delete)
+    SYSCALL(clock_settime) SYSCALL(clock_gettime) SYSCALL(clock_getres)
+    SYSCALL(clock_nanosleep) SYSCALL(exit_group) SYSCALL(epoll_wait) SYSCALL(epoll_ctl)
+    SYSCALL(tgkill) SYSCALL(utimes) SYSCALL(vserver) SYSCALL(mbind)
+    SYSCALL(set_mempolicy) SYSCALL(get_mempolicy) SYSCALL(mq_open) SYSCALL(mq_unlink)
+    SYSCALL(mq_timedsend) SYSCALL(mq_timedreceive) SYSCALL(mq_notify)
+    SYSCALL(mq_getsetattr) SYSCALL(kexec_load) SYSCALL(waitid) SYSCALL(add_key)
+    SYSCALL(request_key) SYSCALL(keyctl) SYSCALL(ioprio_set) SYSCALL(ioprio_get)
+    SYSCALL(inotify_init) SYSCALL(inotify_add_watch) SYSCALL(inotify_rm_watch)
+    SYSCALL(migrate_pages) SYSCALL(openat) SYSCALL(mkdirat) SYSCALL(mknodat)
+    SYSCALL(fchownat) SYSCALL(futimesat) SYSCALL(newfstatat) SYSCALL(unlinkat)
+    SYSCALL(renameat) SYSCALL(linkat) SYSCALL(symlinkat) SYSCALL(readlinkat)
+    SYSCALL(fchmodat) SYSCALL(faccessat) SYSCALL(pselect6) SYSCALL(ppoll)
+    SYSCALL(unshare) SYSCALL(set_robust_list) SYSCALL(get_robust_list) SYSCALL(splice)
+    SYSCALL(tee) SYSCALL(sync_file_range) SYSCALL(vmsplice) SYSCALL(move_pages)
+    SYSCALL(utimensat) SYSCALL(epoll_pwait) SYSCALL(signalfd) SYSCALL(timerfd_create)
+    SYSCALL(eventfd) SYSCALL(fallocate) SYSCALL(timerfd_settime)
+    SYSCALL(timerfd_gettime) SYSCALL(accept4) SYSCALL(signalfd4) SYSCALL(eventfd2)
+    SYSCALL(epoll_create1) SYSCALL(dup3) SYSCALL(pipe2) SYSCALL(inotify_init1)
+    SYSCALL(preadv) SYSCALL(pwritev) SYSCALL(rt_tgsigqueueinfo) SYSCALL(perf_event_open)
+    SYSCALL(recvmmsg) SYSCALL(fanotify_init) SYSCALL(fanotify_mark) SYSCALL(prlimit64)
+    SYSCALL(name_to_handle_at) SYSCALL(open_by_handle_at) SYSCALL(clock_adjtime)
+    SYSCALL(syncfs) SYSCALL(sendmmsg) SYSCALL(setns) SYSCALL(getcpu)
+    SYSCALL(process_vm_readv) SYSCALL(process_vm_writev) SYSCALL(kcmp)
+    SYSCALL(finit_module) SYSCALL(sched_setattr) SYSCALL(sched_getattr)
+    SYSCALL(renameat2) SYSCALL(seccomp) SYSCALL(getrandom) SYSCALL(memfd_create)
+    SYSCALL(kexec_file_load) SYSCALL(bpf) SYSCALL(execveat) SYSCALL(userfaultfd)
+    SYSCALL(membarrier) SYSCALL(mlock2) SYSCALL(copy_file_range) SYSCALL(preadv2)
+    SYSCALL(pwritev2) SYSCALL(pkey_mprotect) SYSCALL(pkey_alloc) SYSCALL(pkey_free)
+    SYSCALL(statx) SYSCALL(io_pgetevents) SYSCALL(rseq)
+};
+
+#undef SYSCALL
+
+#define SYSCALL_NAME_COUNT (sizeof(syscall_names) / sizeof(syscall_names[0]))
+
+#endif
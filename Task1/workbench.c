@@ -0,0 +1,1195 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "syscall_names.h"
+
+// scripted version of the manual Task1 workflow (strace + objdump + gdb)
+//
+// runs an ELF twice: once under ptrace to count system calls and their
+// latency, once under a perf_event_open cpu-clock sampler whose IPs are
+// mapped back to the ELF symbol table. Results print as a summary and can
+// be saved as a line-per-entry JSON report that diffs cleanly, either with
+// plain diff or with `workbench -d base.json new.json`
+
+#define MAX_SYSCALL 512
+#define DEFAULT_FREQUENCY 4000
+#define RING_PAGES 64
+#define MAX_NAME 256
+#define TOP_SYMBOLS 25
+
+// thresholds used when diffing two reports
+#define CALL_CHANGE_PERCENT 10.0
+#define HOTSPOT_MIN_PERCENT 1.0
+#define HOTSPOT_CHANGE_POINTS 2.0
+
+typedef struct {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} SyscallStats;
+
+typedef struct {
+    pid_t tid;
+    int in_syscall;
+    long nr;
+    uint64_t start_ns;
+} TracedThread;
+
+typedef struct {
+    uint64_t addr;
+    uint64_t size;
+    uint64_t section_end;    // end of the section holding the symbol
+    char *name;
+} Symbol;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t vaddr;
+    uint64_t filesz;
+} Segment;
+
+typedef struct {
+    Symbol *symbols;
+    size_t symbol_count;
+    Segment segments[16];
+    size_t segment_count;
+} ElfImage;
+
+typedef struct {
+    uint64_t start;
+    uint64_t length;
+    uint64_t pgoff;
+    char name[MAX_NAME];
+} Mapping;
+
+typedef struct {
+    char name[MAX_NAME];
+    uint64_t samples;
+} Hotspot;
+
+typedef struct {
+    int available;
+    char error[MAX_NAME];
+    int frequency;
+    uint64_t samples;
+    uint64_t lost;
+    Hotspot *hotspots;
+    size_t hotspot_count;
+} Profile;
+
+typedef struct {
+    const char *source;
+    SyscallStats stats[MAX_SYSCALL];
+    uint64_t unknown_calls;
+    int available;
+    char error[MAX_NAME];
+} SyscallReport;
+
+typedef struct {
+    const char *input;       // stdin for the target, NULL to inherit
+    int timeout;             // seconds before the target is killed, 0 = none
+    int frequency;
+} RunOptions;
+
+static volatile pid_t timeout_target = 0;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void on_timeout(int sig) {
+    (void)sig;
+    if (timeout_target > 0) {
+        kill(timeout_target, SIGKILL);
+    }
+}
+
+static void arm_timeout(pid_t pid, int seconds) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_timeout;   // no SA_RESTART, so waitpid() returns EINTR
+    sigaction(SIGALRM, &sa, NULL);
+    timeout_target = pid;
+    alarm(seconds);
+}
+
+static void disarm_timeout() {
+    alarm(0);
+    timeout_target = 0;
+}
+
+static const char *syscall_name(long nr, char *scratch, size_t size) {
+    if (nr >= 0 && (size_t)nr < SYSCALL_NAME_COUNT && syscall_names[nr]) {
+        return syscall_names[nr];
+    }
+    snprintf(scratch, size, "syscall_%ld", nr);
+    return scratch;
+}
+
+static long syscall_number(const char *name) {
+    for (size_t i = 0; i < SYSCALL_NAME_COUNT; i++) {
+        if (syscall_names[i] && strcmp(syscall_names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (strncmp(name, "syscall_", 8) == 0) {
+        return strtol(name + 8, NULL, 10);
+    }
+    return -1;
+}
+
+// redirect stdin of the target before exec
+static void setup_child_stdin(const char *input) {
+    if (!input) {
+        return;
+    }
+    int fd = open(input, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening target input");
+        _exit(127);
+    }
+    dup2(fd, STDIN_FILENO);
+    close(fd);
+}
+
+/* ---------------------------------------------------------------------- */
+/* ELF symbol table                                                       */
+/* ---------------------------------------------------------------------- */
+
+static int compare_symbols(const void *a, const void *b) {
+    const Symbol *x = a, *y = b;
+    return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+// load code symbols (functions and assembly labels) and PT_LOAD segments
+static int load_elf(const char *path, ElfImage *image) {
+    memset(image, 0, sizeof(*image));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(Elf64_Ehdr)) {
+        close(fd);
+        return -1;
+    }
+    unsigned char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    Elf64_Ehdr *ehdr = (Elf64_Ehdr *)data;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS64) {
+        munmap(data, st.st_size);
+        return -1;
+    }
+
+    Elf64_Phdr *phdrs = (Elf64_Phdr *)(data + ehdr->e_phoff);
+    for (int i = 0; i < ehdr->e_phnum && image->segment_count < 16; i++) {
+        if (phdrs[i].p_type == PT_LOAD) {
+            Segment *seg = &image->segments[image->segment_count++];
+            seg->offset = phdrs[i].p_offset;
+            seg->vaddr = phdrs[i].p_vaddr;
+            seg->filesz = phdrs[i].p_filesz;
+        }
+    }
+
+    Elf64_Shdr *shdrs = (Elf64_Shdr *)(data + ehdr->e_shoff);
+    Elf64_Shdr *symtab = NULL;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        if (shdrs[i].sh_type == SHT_SYMTAB) {
+            symtab = &shdrs[i];
+        } else if (shdrs[i].sh_type == SHT_DYNSYM && !symtab) {
+            symtab = &shdrs[i];
+        }
+    }
+
+    if (symtab) {
+        Elf64_Sym *syms = (Elf64_Sym *)(data + symtab->sh_offset);
+        size_t count = symtab->sh_size / sizeof(Elf64_Sym);
+        const char *strings = (const char *)(data + shdrs[symtab->sh_link].sh_offset);
+
+        image->symbols = calloc(count, sizeof(Symbol));
+        for (size_t i = 0; i < count; i++) {
+            int type = ELF64_ST_TYPE(syms[i].st_info);
+            uint16_t section = syms[i].st_shndx;
+
+            if ((type != STT_FUNC && type != STT_NOTYPE) || syms[i].st_value == 0 ||
+                section == SHN_UNDEF || section >= ehdr->e_shnum ||
+                !(shdrs[section].sh_flags & SHF_EXECINSTR) || strings[syms[i].st_name] == '\0') {
+                continue;
+            }
+            Symbol *sym = &image->symbols[image->symbol_count++];
+            sym->addr = syms[i].st_value;
+            sym->size = syms[i].st_size;
+            sym->section_end = shdrs[section].sh_addr + shdrs[section].sh_size;
+            sym->name = strdup(strings + syms[i].st_name);
+        }
+        qsort(image->symbols, image->symbol_count, sizeof(Symbol), compare_symbols);
+
+        // assembly labels have no size: extend them to the next symbol,
+        // but never past the end of their own section (so _init in .init
+        // does not swallow .plt)
+        for (size_t i = 0; i < image->symbol_count; i++) {
+            Symbol *sym = &image->symbols[i];
+            if (sym->size != 0) {
+                continue;
+            }
+            uint64_t end = sym->section_end;
+            for (size_t j = i + 1; j < image->symbol_count; j++) {
+                if (image->symbols[j].addr > sym->addr) {
+                    if (image->symbols[j].addr < end) {
+                        end = image->symbols[j].addr;
+                    }
+                    break;
+                }
+            }
+            sym->size = end > sym->addr ? end - sym->addr : 0;
+        }
+    }
+
+    munmap(data, st.st_size);
+    return 0;
+}
+
+static const char *lookup_symbol(const ElfImage *image, uint64_t vaddr) {
+    size_t low = 0, high = image->symbol_count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (image->symbols[mid].addr <= vaddr) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return NULL;
+    }
+    const Symbol *sym = &image->symbols[low - 1];
+    if (vaddr < sym->addr + sym->size) {
+        return sym->name;
+    }
+    return NULL;
+}
+
+// translate a file offset into the ELF's link-time virtual address
+static int offset_to_vaddr(const ElfImage *image, uint64_t offset, uint64_t *vaddr) {
+    for (size_t i = 0; i < image->segment_count; i++) {
+        const Segment *seg = &image->segments[i];
+        if (offset >= seg->offset && offset < seg->offset + seg->filesz) {
+            *vaddr = offset - seg->offset + seg->vaddr;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* System call tracing                                                    */
+/* ---------------------------------------------------------------------- */
+
+static TracedThread *find_thread(TracedThread **threads, size_t *count, pid_t tid, int *is_new) {
+    for (size_t i = 0; i < *count; i++) {
+        if ((*threads)[i].tid == tid) {
+            *is_new = 0;
+            return &(*threads)[i];
+        }
+    }
+    *threads = realloc(*threads, (*count + 1) * sizeof(TracedThread));
+    TracedThread *thread = &(*threads)[(*count)++];
+    memset(thread, 0, sizeof(*thread));
+    thread->tid = tid;
+    *is_new = 1;
+    return thread;
+}
+
+// note: latencies include the cost of two ptrace stops per call, so they
+// are best compared against another ptrace run rather than taken as absolute
+static int trace_syscalls(char *const argv[], const RunOptions *options, SyscallReport *report) {
+    report->source = "ptrace";
+
+    pid_t child = fork();
+    if (child < 0) {
+        snprintf(report->error, sizeof(report->error), "fork: %s", strerror(errno));
+        return -1;
+    }
+
+    if (child == 0) {
+        setup_child_stdin(options->input);
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) < 0) {
+            _exit(126);
+        }
+        raise(SIGSTOP);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(child, &status, 0) < 0 || !WIFSTOPPED(status)) {
+        snprintf(report->error, sizeof(report->error), "ptrace not permitted");
+        return -1;
+    }
+
+    ptrace(PTRACE_SETOPTIONS, child, NULL,
+           PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK |
+           PTRACE_O_TRACEVFORK | PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, child, NULL, NULL);
+
+    if (options->timeout > 0) {
+        arm_timeout(child, options->timeout);
+    }
+
+    TracedThread *threads = NULL;
+    size_t thread_count = 0;
+    int is_new;
+    find_thread(&threads, &thread_count, child, &is_new);
+
+    for (;;) {
+        pid_t tid = waitpid(-1, &status, __WALL);
+        if (tid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;   // ECHILD: every traced task has exited
+        }
+
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            continue;
+        }
+
+        TracedThread *thread = find_thread(&threads, &thread_count, tid, &is_new);
+        int sig = WSTOPSIG(status);
+        int inject = 0;
+
+        if (sig == (SIGTRAP | 0x80)) {
+            struct user_regs_struct regs;
+            ptrace(PTRACE_GETREGS, tid, NULL, &regs);
+
+            // on x86-64 rax holds -ENOSYS at syscall entry
+            if (!thread->in_syscall && (long)regs.rax == -ENOSYS) {
+                thread->in_syscall = 1;
+                thread->nr = regs.orig_rax;
+                thread->start_ns = now_ns();
+                if (thread->nr >= 0 && thread->nr < MAX_SYSCALL) {
+                    report->stats[thread->nr].calls++;
+                } else {
+                    report->unknown_calls++;
+                }
+            } else if (thread->in_syscall) {
+                uint64_t elapsed = now_ns() - thread->start_ns;
+                thread->in_syscall = 0;
+                if (thread->nr >= 0 && thread->nr < MAX_SYSCALL) {
+                    SyscallStats *stats = &report->stats[thread->nr];
+                    stats->total_ns += elapsed;
+                    if (elapsed > stats->max_ns) {
+                        stats->max_ns = elapsed;
+                    }
+                    long ret = regs.rax;
+                    if (ret < 0 && ret >= -4095) {
+                        stats->errors++;
+                    }
+                }
+            }
+        } else if (status >> 16) {
+            // ptrace event stop (clone/fork/exec); an exec replaces all
+            // threads, so a pending entry on the leader must be discarded
+            if ((status >> 16) == PTRACE_EVENT_EXEC) {
+                thread->in_syscall = 1;
+            }
+        } else if (sig == SIGSTOP && is_new) {
+            // initial stop of a newly attached thread or child
+        } else {
+            inject = sig;
+        }
+
+        ptrace(PTRACE_SYSCALL, tid, NULL, (void *)(long)inject);
+    }
+
+    disarm_timeout();
+    free(threads);
+    report->available = 1;
+    return 0;
+}
+
+// fallback when ptrace is unavailable: import `strace -f -T -o LOG` output
+static int import_strace_log(const char *path, SyscallReport *report) {
+    report->source = "strace-log";
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        snprintf(report->error, sizeof(report->error), "%s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, file) != -1) {
+        char *p = line;
+        char name[64];
+
+        // skip an optional "[pid N]" or bare pid prefix
+        if (strncmp(p, "[pid", 4) == 0) {
+            p = strchr(p, ']');
+            if (!p) {
+                continue;
+            }
+            p++;
+        }
+        while (*p == ' ' || (*p >= '0' && *p <= '9')) {
+            p++;
+        }
+
+        if (*p == '+' || *p == '-' || strstr(p, "<unfinished ...>")) {
+            continue;   // signals, exits, or calls finished on a later line
+        }
+
+        if (strncmp(p, "<... ", 5) == 0) {
+            if (sscanf(p + 5, "%63[a-z0-9_]", name) != 1) {
+                continue;
+            }
+        } else if (sscanf(p, "%63[a-z0-9_]", name) != 1 || p[strlen(name)] != '(') {
+            continue;
+        }
+
+        long nr = syscall_number(name);
+        if (nr < 0 || nr >= MAX_SYSCALL) {
+            report->unknown_calls++;
+            continue;
+        }
+
+        SyscallStats *stats = &report->stats[nr];
+        stats->calls++;
+
+        char *result = strstr(p, ") = ");
+        if (result && strtol(result + 4, NULL, 10) < 0) {
+            stats->errors++;
+        }
+
+        char *latency = strrchr(p, '<');
+        if (latency) {
+            uint64_t ns = (uint64_t)(strtod(latency + 1, NULL) * 1e9);
+            stats->total_ns += ns;
+            if (ns > stats->max_ns) {
+                stats->max_ns = ns;
+            }
+        }
+    }
+
+    free(line);
+    fclose(file);
+    report->available = 1;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Sampling profile                                                       */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    uint64_t *ips;
+    size_t ip_count;
+    size_t ip_capacity;
+    Mapping *mappings;
+    size_t mapping_count;
+    uint64_t lost;
+} SampleBuffer;
+
+static void handle_record(SampleBuffer *samples, struct perf_event_header *header) {
+    char *body = (char *)(header + 1);
+
+    if (header->type == PERF_RECORD_SAMPLE) {
+        if (samples->ip_count == samples->ip_capacity) {
+            samples->ip_capacity = samples->ip_capacity ? samples->ip_capacity * 2 : 4096;
+            samples->ips = realloc(samples->ips, samples->ip_capacity * sizeof(uint64_t));
+        }
+        samples->ips[samples->ip_count++] = *(uint64_t *)body;
+    } else if (header->type == PERF_RECORD_MMAP) {
+        struct {
+            uint32_t pid, tid;
+            uint64_t addr, len, pgoff;
+            char filename[];
+        } *record = (void *)body;
+
+        samples->mappings = realloc(samples->mappings, (samples->mapping_count + 1) * sizeof(Mapping));
+        Mapping *mapping = &samples->mappings[samples->mapping_count++];
+        mapping->start = record->addr;
+        mapping->length = record->len;
+        mapping->pgoff = record->pgoff;
+        snprintf(mapping->name, sizeof(mapping->name), "%s", record->filename);
+    } else if (header->type == PERF_RECORD_LOST) {
+        samples->lost += ((uint64_t *)body)[1];
+    }
+}
+
+static void drain_ring(struct perf_event_mmap_page *meta, size_t data_size, SampleBuffer *samples) {
+    char *data = (char *)meta + sysconf(_SC_PAGESIZE);
+    uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = meta->data_tail;
+    char record[4096] __attribute__((aligned(8)));
+
+    while (tail < head) {
+        struct perf_event_header *header = (void *)(data + tail % data_size);
+        size_t size = header->size;
+        if (size == 0 || size > sizeof(record)) {
+            break;
+        }
+
+        // records may wrap around the end of the ring
+        size_t offset = tail % data_size;
+        size_t first = size < data_size - offset ? size : data_size - offset;
+        memcpy(record, data + offset, first);
+        memcpy(record + first, data, size - first);
+
+        handle_record(samples, (struct perf_event_header *)record);
+        tail += size;
+    }
+
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+static int compare_hotspots(const void *a, const void *b) {
+    const Hotspot *x = a, *y = b;
+    if (x->samples != y->samples) {
+        return x->samples < y->samples ? 1 : -1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+static void add_hotspot(Profile *profile, const char *name) {
+    for (size_t i = 0; i < profile->hotspot_count; i++) {
+        if (strcmp(profile->hotspots[i].name, name) == 0) {
+            profile->hotspots[i].samples++;
+            return;
+        }
+    }
+    profile->hotspots = realloc(profile->hotspots, (profile->hotspot_count + 1) * sizeof(Hotspot));
+    Hotspot *hotspot = &profile->hotspots[profile->hotspot_count++];
+    snprintf(hotspot->name, sizeof(hotspot->name), "%s", name);
+    hotspot->samples = 1;
+}
+
+// attribute each sample to a symbol in the target, or to the mapped
+// object (shared library, vdso) it landed in
+static void symbolize(Profile *profile, SampleBuffer *samples, const char *binary, const ElfImage *image) {
+    char label[MAX_NAME];
+
+    for (size_t i = 0; i < samples->ip_count; i++) {
+        uint64_t ip = samples->ips[i];
+        const Mapping *mapping = NULL;
+
+        for (size_t m = 0; m < samples->mapping_count; m++) {
+            const Mapping *candidate = &samples->mappings[m];
+            if (ip >= candidate->start && ip < candidate->start + candidate->length) {
+                mapping = candidate;
+            }
+        }
+
+        const char *name = "[unknown]";
+        if (mapping && strcmp(mapping->name, binary) == 0) {
+            uint64_t vaddr;
+            const char *symbol = NULL;
+            if (offset_to_vaddr(image, ip - mapping->start + mapping->pgoff, &vaddr) == 0) {
+                symbol = lookup_symbol(image, vaddr);
+            }
+            name = symbol ? symbol : "[unknown]";
+        } else if (mapping) {
+            const char *base = strrchr(mapping->name, '/');
+            snprintf(label, sizeof(label), "[%.*s]", MAX_NAME - 3, base ? base + 1 : mapping->name);
+            name = label;
+        }
+        add_hotspot(profile, name);
+    }
+
+    profile->samples = samples->ip_count;
+    profile->lost = samples->lost;
+    qsort(profile->hotspots, profile->hotspot_count, sizeof(Hotspot), compare_hotspots);
+}
+
+static int profile_run(char *const argv[], const char *binary, const ElfImage *image,
+                       const RunOptions *options, Profile *profile) {
+    profile->frequency = options->frequency;
+
+    int sync_pipe[2];
+    if (pipe(sync_pipe) < 0) {
+        snprintf(profile->error, sizeof(profile->error), "pipe: %s", strerror(errno));
+        return -1;
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        snprintf(profile->error, sizeof(profile->error), "fork: %s", strerror(errno));
+        return -1;
+    }
+
+    if (child == 0) {
+        // wait until the parent has attached the counter, then exec
+        char byte;
+        close(sync_pipe[1]);
+        if (read(sync_pipe[0], &byte, 1) != 0) {
+            _exit(126);
+        }
+        close(sync_pipe[0]);
+        setup_child_stdin(options->input);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    close(sync_pipe[0]);
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = options->frequency;
+    attr.sample_type = PERF_SAMPLE_IP;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;
+    attr.mmap = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // inherited events cannot be mmapped per task, so like `perf record`
+    // open one counter and ring buffer per CPU, all following the child
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t data_size = RING_PAGES * page_size;
+    struct pollfd *fds = calloc(cpu_count, sizeof(struct pollfd));
+    void **rings = calloc(cpu_count, sizeof(void *));
+    int ring_count = 0;
+    int open_error = 0;
+
+    for (long cpu = 0; cpu < cpu_count; cpu++) {
+        int fd = syscall(SYS_perf_event_open, &attr, child, cpu, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) {
+            open_error = errno;   // offline CPUs fail with ENODEV; skip them
+            continue;
+        }
+        void *ring = mmap(NULL, page_size + data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ring == MAP_FAILED) {
+            open_error = errno;
+            close(fd);
+            continue;
+        }
+        fds[ring_count].fd = fd;
+        fds[ring_count].events = POLLIN;
+        rings[ring_count++] = ring;
+    }
+
+    if (ring_count == 0) {
+        snprintf(profile->error, sizeof(profile->error), "perf_event_open: %s", strerror(open_error));
+        kill(child, SIGKILL);
+        close(sync_pipe[1]);
+        waitpid(child, NULL, 0);
+        free(fds);
+        free(rings);
+        return -1;
+    }
+
+    close(sync_pipe[1]);   // releases the child into execvp
+
+    SampleBuffer samples;
+    memset(&samples, 0, sizeof(samples));
+    uint64_t deadline = options->timeout > 0 ? now_ns() + options->timeout * 1000000000ULL : 0;
+    int status;
+
+    for (;;) {
+        poll(fds, ring_count, 100);
+        for (int i = 0; i < ring_count; i++) {
+            drain_ring(rings[i], data_size, &samples);
+        }
+
+        if (waitpid(child, &status, WNOHANG) == child) {
+            break;
+        }
+        if (deadline && now_ns() >= deadline) {
+            kill(child, SIGKILL);
+            waitpid(child, &status, 0);
+            break;
+        }
+    }
+
+    for (int i = 0; i < ring_count; i++) {
+        drain_ring(rings[i], data_size, &samples);
+        munmap(rings[i], page_size + data_size);
+        close(fds[i].fd);
+    }
+    free(fds);
+    free(rings);
+
+    symbolize(profile, &samples, binary, image);
+    free(samples.ips);
+    free(samples.mappings);
+    profile->available = 1;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Reports                                                                */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    long nr;
+    const SyscallStats *stats;
+} SyscallRow;
+
+static int compare_rows_by_time(const void *a, const void *b) {
+    const SyscallRow *x = a, *y = b;
+    if (x->stats->total_ns != y->stats->total_ns) {
+        return x->stats->total_ns < y->stats->total_ns ? 1 : -1;
+    }
+    return (x->stats->calls < y->stats->calls) - (x->stats->calls > y->stats->calls);
+}
+
+static void print_summary(const char *binary, const SyscallReport *syscalls, const Profile *profile) {
+    char scratch[32];
+    printf("== %s ==\n\n", binary);
+
+    if (!syscalls->available) {
+        printf("syscalls: unavailable (%s)\n\n", syscalls->error);
+    } else {
+        SyscallRow rows[MAX_SYSCALL];
+        size_t row_count = 0;
+        uint64_t total_ns = 0, total_calls = 0, total_errors = 0;
+
+        for (long nr = 0; nr < MAX_SYSCALL; nr++) {
+            if (syscalls->stats[nr].calls) {
+                rows[row_count].nr = nr;
+                rows[row_count++].stats = &syscalls->stats[nr];
+                total_ns += syscalls->stats[nr].total_ns;
+                total_calls += syscalls->stats[nr].calls;
+                total_errors += syscalls->stats[nr].errors;
+            }
+        }
+        qsort(rows, row_count, sizeof(SyscallRow), compare_rows_by_time);
+
+        printf("syscalls (%s): %llu calls, %llu errors\n", syscalls->source,
+               (unsigned long long)total_calls, (unsigned long long)total_errors);
+        printf("  %6s %11s %11s %11s %9s %7s  %s\n",
+               "% time", "seconds", "usecs/call", "max usecs", "calls", "errors", "syscall");
+        for (size_t i = 0; i < row_count; i++) {
+            const SyscallStats *s = rows[i].stats;
+            printf("  %6.2f %11.6f %11.2f %11.2f %9llu %7llu  %s\n",
+                   total_ns ? 100.0 * s->total_ns / total_ns : 0.0,
+                   s->total_ns / 1e9,
+                   s->total_ns / 1e3 / s->calls,
+                   s->max_ns / 1e3,
+                   (unsigned long long)s->calls,
+                   (unsigned long long)s->errors,
+                   syscall_name(rows[i].nr, scratch, sizeof(scratch)));
+        }
+        if (syscalls->unknown_calls) {
+            printf("  (%llu calls outside the known syscall range)\n",
+                   (unsigned long long)syscalls->unknown_calls);
+        }
+        printf("\n");
+    }
+
+    if (!profile->available) {
+        printf("profile: unavailable (%s)\n", profile->error);
+        return;
+    }
+
+    printf("profile (cpu-clock @ %d Hz, user space): %llu samples, %llu lost\n",
+           profile->frequency, (unsigned long long)profile->samples,
+           (unsigned long long)profile->lost);
+    printf("  %9s %8s  %s\n", "samples", "percent", "symbol");
+    for (size_t i = 0; i < profile->hotspot_count && i < TOP_SYMBOLS; i++) {
+        printf("  %9llu %7.2f%%  %s\n", (unsigned long long)profile->hotspots[i].samples,
+               100.0 * profile->hotspots[i].samples / profile->samples, profile->hotspots[i].name);
+    }
+}
+
+static void write_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static int compare_hotspot_names(const void *a, const void *b) {
+    return strcmp(((const Hotspot *)a)->name, ((const Hotspot *)b)->name);
+}
+
+// one entry per line, keys sorted, so reports also diff well as text
+static int write_json(const char *path, const char *binary, char *const argv[],
+                      const SyscallReport *syscalls, const Profile *profile) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("Error opening report");
+        return -1;
+    }
+
+    fprintf(out, "{\n  \"binary\": ");
+    write_json_string(out, binary);
+    fprintf(out, ",\n  \"args\": [");
+    for (int i = 1; argv[i]; i++) {
+        fprintf(out, i > 1 ? ", " : "");
+        write_json_string(out, argv[i]);
+    }
+    fprintf(out, "],\n  \"syscall_source\": ");
+    write_json_string(out, syscalls->available ? syscalls->source : "unavailable");
+    fprintf(out, ",\n  \"syscalls\": {\n");
+
+    if (syscalls->available) {
+        const char *names[MAX_SYSCALL];
+        char scratch[MAX_SYSCALL][32];
+        size_t count = 0;
+        for (long nr = 0; nr < MAX_SYSCALL; nr++) {
+            if (syscalls->stats[nr].calls) {
+                names[count++] = syscall_name(nr, scratch[nr], sizeof(scratch[nr]));
+            }
+        }
+        qsort(names, count, sizeof(names[0]), compare_names);
+
+        for (size_t i = 0; i < count; i++) {
+            const SyscallStats *s = &syscalls->stats[syscall_number(names[i])];
+            fprintf(out, "    \"%s\": {\"calls\": %llu, \"errors\": %llu, \"total_us\": %.3f, \"max_us\": %.3f}%s\n",
+                    names[i], (unsigned long long)s->calls, (unsigned long long)s->errors,
+                    s->total_ns / 1e3, s->max_ns / 1e3, i + 1 < count ? "," : "");
+        }
+    }
+
+    fprintf(out, "  },\n  \"profile\": {\"available\": %s, \"frequency\": %d, \"samples\": %llu, \"lost\": %llu},\n",
+            profile->available ? "true" : "false", profile->frequency,
+            (unsigned long long)profile->samples, (unsigned long long)profile->lost);
+    fprintf(out, "  \"hotspots\": {\n");
+
+    Hotspot *sorted = malloc((profile->hotspot_count + 1) * sizeof(Hotspot));
+    memcpy(sorted, profile->hotspots, profile->hotspot_count * sizeof(Hotspot));
+    qsort(sorted, profile->hotspot_count, sizeof(Hotspot), compare_hotspot_names);
+    for (size_t i = 0; i < profile->hotspot_count; i++) {
+        fprintf(out, "    ");
+        write_json_string(out, sorted[i].name);
+        fprintf(out, ": {\"samples\": %llu, \"percent\": %.2f}%s\n",
+                (unsigned long long)sorted[i].samples,
+                100.0 * sorted[i].samples / profile->samples,
+                i + 1 < profile->hotspot_count ? "," : "");
+    }
+    free(sorted);
+
+    fprintf(out, "  }\n}\n");
+    fclose(out);
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Report diff                                                            */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    char name[MAX_NAME];
+    double value;    // calls for syscalls, percent for hotspots
+} Entry;
+
+typedef struct {
+    Entry *syscalls;
+    size_t syscall_count;
+    Entry *hotspots;
+    size_t hotspot_count;
+} ParsedReport;
+
+static void add_entry(Entry **entries, size_t *count, const char *name, double value) {
+    *entries = realloc(*entries, (*count + 1) * sizeof(Entry));
+    snprintf((*entries)[*count].name, MAX_NAME, "%s", name);
+    (*entries)[(*count)++].value = value;
+}
+
+// reads the format produced by write_json; not a general JSON parser
+static int read_report(const char *path, ParsedReport *report) {
+    memset(report, 0, sizeof(*report));
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    int section = 0;   // 1 = syscalls, 2 = hotspots
+
+    while (getline(&line, &capacity, file) != -1) {
+        if (strstr(line, "\"syscalls\": {")) {
+            section = 1;
+            continue;
+        }
+        if (strstr(line, "\"hotspots\": {")) {
+            section = 2;
+            continue;
+        }
+        if (strncmp(line, "  }", 3) == 0) {
+            section = 0;
+            continue;
+        }
+        if (!section) {
+            continue;
+        }
+
+        // "    \"name\": {\"key\": value, ..."
+        char *start = strchr(line, '"');
+        char *end = start ? strstr(start + 1, "\": {") : NULL;
+        if (!end) {
+            continue;
+        }
+        char name[MAX_NAME];
+        size_t length = 0;
+        for (char *p = start + 1; p < end && length + 1 < sizeof(name); p++) {
+            if (*p == '\\' && p + 1 < end) {
+                p++;
+            }
+            name[length++] = *p;
+        }
+        name[length] = '\0';
+
+        const char *key = section == 1 ? "\"calls\": " : "\"percent\": ";
+        char *value = strstr(end, key);
+        if (!value) {
+            continue;
+        }
+        double number = strtod(value + strlen(key), NULL);
+        if (section == 1) {
+            add_entry(&report->syscalls, &report->syscall_count, name, number);
+        } else {
+            add_entry(&report->hotspots, &report->hotspot_count, name, number);
+        }
+    }
+
+    free(line);
+    fclose(file);
+    return 0;
+}
+
+static double find_entry(const Entry *entries, size_t count, const char *name, int *found) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            *found = 1;
+            return entries[i].value;
+        }
+    }
+    *found = 0;
+    return 0;
+}
+
+// returns the number of new syscalls and new significant hotspots
+static int diff_section(const char *title, const Entry *base, size_t base_count,
+                        const Entry *next, size_t next_count, int is_hotspot) {
+    int additions = 0;
+    int found;
+    printf("%s:\n", title);
+
+    for (size_t i = 0; i < next_count; i++) {
+        double before = find_entry(base, base_count, next[i].name, &found);
+        double after = next[i].value;
+
+        if (!found) {
+            if (is_hotspot && after < HOTSPOT_MIN_PERCENT) {
+                continue;
+            }
+            additions++;
+            if (is_hotspot) {
+                printf("  + %-28s %7.2f%% (new)\n", next[i].name, after);
+            } else {
+                printf("  + %-28s %9.0f calls (new)\n", next[i].name, after);
+            }
+        } else if (is_hotspot && (after - before > HOTSPOT_CHANGE_POINTS ||
+                                  before - after > HOTSPOT_CHANGE_POINTS)) {
+            printf("  ~ %-28s %7.2f%% -> %6.2f%%\n", next[i].name, before, after);
+        } else if (!is_hotspot && before > 0 &&
+                   (after - before) * 100.0 / before > CALL_CHANGE_PERCENT) {
+            printf("  ~ %-28s %9.0f -> %.0f calls (%+.1f%%)\n", next[i].name, before, after,
+                   (after - before) * 100.0 / before);
+        } else if (!is_hotspot && before > 0 &&
+                   (before - after) * 100.0 / before > CALL_CHANGE_PERCENT) {
+            printf("  ~ %-28s %9.0f -> %.0f calls (%+.1f%%)\n", next[i].name, before, after,
+                   (after - before) * 100.0 / before);
+        }
+    }
+
+    for (size_t i = 0; i < base_count; i++) {
+        find_entry(next, next_count, base[i].name, &found);
+        if (!found && (!is_hotspot || base[i].value >= HOTSPOT_MIN_PERCENT)) {
+            printf("  - %-28s (gone)\n", base[i].name);
+        }
+    }
+    return additions;
+}
+
+static int diff_reports(const char *base_path, const char *next_path) {
+    ParsedReport base, next;
+    if (read_report(base_path, &base) < 0 || read_report(next_path, &next) < 0) {
+        return 2;
+    }
+
+    int additions = diff_section("syscalls", base.syscalls, base.syscall_count,
+                                 next.syscalls, next.syscall_count, 0);
+    additions += diff_section("hotspots", base.hotspots, base.hotspot_count,
+                              next.hotspots, next.hotspot_count, 1);
+
+    free(base.syscalls);
+    free(base.hotspots);
+    free(next.syscalls);
+    free(next.hotspots);
+
+    if (additions) {
+        printf("%d new syscall(s)/hotspot(s)\n", additions);
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+// find the ELF that execvp would run
+static int resolve_binary(const char *name, char *resolved) {
+    if (strchr(name, '/')) {
+        return realpath(name, resolved) ? 0 : -1;
+    }
+
+    const char *path = getenv("PATH");
+    char candidate[PATH_MAX];
+    while (path && *path) {
+        const char *end = strchr(path, ':');
+        size_t length = end ? (size_t)(end - path) : strlen(path);
+        snprintf(candidate, sizeof(candidate), "%.*s/%s", (int)length, path, name);
+        if (access(candidate, X_OK) == 0) {
+            return realpath(candidate, resolved) ? 0 : -1;
+        }
+        path = end ? end + 1 : NULL;
+    }
+    return -1;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options] BINARY [ARGS...]\n"
+            "       %s -d BASE.json NEW.json\n"
+            "  -o FILE   write a JSON report\n"
+            "  -s LOG    take syscalls from `strace -f -T -o LOG` instead of ptrace\n"
+            "  -F HZ     sampling frequency (default %d)\n"
+            "  -i FILE   feed FILE to the target's stdin\n"
+            "  -t SECS   kill the target after SECS (for servers)\n"
+            "  -S        skip syscall tracing\n"
+            "  -P        skip sampling profile\n"
+            "  -d        diff two reports; exits 1 if new syscalls or hotspots appear\n",
+            program, program, DEFAULT_FREQUENCY);
+}
+
+int main(int argc, char *argv[]) {
+    RunOptions options = {NULL, 0, DEFAULT_FREQUENCY};
+    const char *report_path = NULL;
+    const char *strace_log = NULL;
+    int skip_syscalls = 0, skip_profile = 0, diff = 0;
+    int opt;
+
+    // '+' stops at the first non-option so the target's own flags pass through
+    while ((opt = getopt(argc, argv, "+o:s:F:i:t:SPdh")) != -1) {
+        switch (opt) {
+            case 'o': report_path = optarg; break;
+            case 's': strace_log = optarg; break;
+            case 'F': options.frequency = atoi(optarg); break;
+            case 'i': options.input = optarg; break;
+            case 't': options.timeout = atoi(optarg); break;
+            case 'S': skip_syscalls = 1; break;
+            case 'P': skip_profile = 1; break;
+            case 'd': diff = 1; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    if (diff) {
+        if (argc - optind != 2) {
+            usage(argv[0]);
+            return 2;
+        }
+        return diff_reports(argv[optind], argv[optind + 1]);
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char *const *target = &argv[optind];
+    char binary[PATH_MAX];
+    if (resolve_binary(target[0], binary) < 0) {
+        fprintf(stderr, "Cannot find %s\n", target[0]);
+        return 2;
+    }
+
+    ElfImage image;
+    if (load_elf(binary, &image) < 0) {
+        fprintf(stderr, "%s is not a 64-bit ELF file\n", binary);
+        return 2;
+    }
+
+    static SyscallReport syscalls;
+    Profile profile;
+    memset(&profile, 0, sizeof(profile));
+    profile.frequency = options.frequency;
+
+    if (strace_log) {
+        import_strace_log(strace_log, &syscalls);
+    } else if (!skip_syscalls) {
+        if (trace_syscalls(target, &options, &syscalls) < 0 && syscalls.error[0] == '\0') {
+            snprintf(syscalls.error, sizeof(syscalls.error), "ptrace failed");
+        }
+    } else {
+        snprintf(syscalls.error, sizeof(syscalls.error), "skipped");
+    }
+
+    if (!skip_profile) {
+        profile_run(target, binary, &image, &options, &profile);
+    } else {
+        snprintf(profile.error, sizeof(profile.error), "skipped");
+    }
+
+    print_summary(binary, &syscalls, &profile);
+
+    if (report_path && write_json(report_path, binary, target, &syscalls, &profile) < 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < image.symbol_count; i++) {
+        free(image.symbols[i].name);
+    }
+    free(image.symbols);
+    free(profile.hotspots);
+    return 0;
+}
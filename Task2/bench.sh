@@ -0,0 +1,35 @@
+#!/bin/sh
+# Build count_names and the harness, generate corpora and check/benchmark them
+#
+# Usage: ./bench.sh [SIZE...]     e.g. ./bench.sh 1M 100M 1G 10G
+# Corpora are written to $CORPUS_DIR (default /tmp/count_names_corpora)
+
+set -e
+cd "$(dirname "$0")"
+
+CORPUS_DIR=${CORPUS_DIR:-/tmp/count_names_corpora}
+SIZES=${*:-1M 64M 512M}
+
+nasm -f elf64 count_names.asm -o count_names.o
+ld -o count_names count_names.o
+gcc -O2 -o gen_names gen_names.c
+gcc -O2 -o bench_count bench_count.c
+
+mkdir -p "$CORPUS_DIR"
+FILES="names.txt"
+for size in $SIZES; do
+    file="$CORPUS_DIR/names_$size.txt"
+    if [ ! -f "$file" ]; then
+        echo "Generating $file"
+        ./gen_names -s "$size" -S 42 -o "$file"
+    fi
+    FILES="$FILES $file"
+done
+
+# edge cases that a random corpus may not hit at small sizes
+printf '' > "$CORPUS_DIR/empty.txt"
+printf 'no newline' > "$CORPUS_DIR/no_newline.txt"
+printf ' \t \r\n\n\t\nname\r\n' > "$CORPUS_DIR/whitespace.txt"
+FILES="$FILES $CORPUS_DIR/empty.txt $CORPUS_DIR/no_newline.txt $CORPUS_DIR/whitespace.txt"
+
+./bench_count -b ./count_names $BENCH_FLAGS $FILES
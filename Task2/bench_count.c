@@ -0,0 +1,430 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <immintrin.h>
+
+#define READ_BUFFER_SIZE (1 << 20)
+#define DEFAULT_RUNS 3
+#define FLOOR_MIN_SIZE (16 << 20)   // smaller files are too quick to time reliably
+
+// correctness and throughput harness for count_names
+//
+// every corpus is first counted by a deliberately simple reference
+// implementation; each variant (scalar/SIMD kernels over read() or mmap()
+// input, plus the count_names binary itself) must agree with it and is
+// timed over several runs, reporting the best throughput in GB/s
+
+// line scanning state carried across buffers
+typedef struct {
+    uint64_t count;
+    int in_name;   // current line has a non-whitespace character
+} CountState;
+
+typedef void (*scan_fn)(CountState *state, const unsigned char *data, size_t length);
+
+typedef struct {
+    const char *name;
+    int use_mmap;
+    scan_fn scan;
+    int (*supported)(void);
+} Variant;
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// reference: a line is a name if it holds anything other than spaces,
+// tabs and carriage returns, so blank CRLF lines ("\r\n", " \t\r\n") are
+// not names
+static long long reference_count(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    long long count = 0;
+
+    while ((length = getline(&line, &capacity, file)) != -1) {
+        for (ssize_t i = 0; i < length; i++) {
+            if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != '\n') {
+                count++;
+                break;
+            }
+        }
+    }
+
+    int failed = ferror(file);
+    free(line);
+    fclose(file);
+    return failed ? -1 : count;
+}
+
+// byte-at-a-time kernel, same algorithm as count_names.asm
+static void scan_scalar(CountState *state, const unsigned char *data, size_t length) {
+    uint64_t count = state->count;
+    int in_name = state->in_name;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = data[i];
+        if (c == '\n') {
+            count += in_name;
+            in_name = 0;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            in_name = 1;
+        }
+    }
+
+    state->count = count;
+    state->in_name = in_name;
+}
+
+// consume one 64-byte block given as newline and non-whitespace bitmasks
+static inline void scan_masks(CountState *state, uint64_t newlines, uint64_t content) {
+    if (newlines == 0) {
+        state->in_name |= content != 0;
+        return;
+    }
+
+    while (newlines) {
+        uint64_t bit = newlines & -newlines;
+        uint64_t before = bit - 1;
+
+        if (state->in_name || (content & before)) {
+            state->count++;
+        }
+        state->in_name = 0;
+        content &= ~(before | bit);
+        newlines &= newlines - 1;
+    }
+    state->in_name = content != 0;
+}
+
+static inline uint64_t sse2_mask(__m128i v0, __m128i v1, __m128i v2, __m128i v3, __m128i c) {
+    return (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v0, c))
+         | (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, c)) << 16
+         | (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v2, c)) << 32
+         | (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v3, c)) << 48;
+}
+
+static void scan_sse2(CountState *state, const unsigned char *data, size_t length) {
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+
+    for (; i + 64 <= length; i += 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(data + i + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(data + i + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(data + i + 48));
+
+        uint64_t newlines = sse2_mask(v0, v1, v2, v3, lf);
+        uint64_t blank = newlines
+                       | sse2_mask(v0, v1, v2, v3, space)
+                       | sse2_mask(v0, v1, v2, v3, tab)
+                       | sse2_mask(v0, v1, v2, v3, cr);
+        scan_masks(state, newlines, ~blank);
+    }
+
+    scan_scalar(state, data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t avx2_mask(__m256i v0, __m256i v1, __m256i c) {
+    return (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, c))
+         | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, c)) << 32;
+}
+
+__attribute__((target("avx2")))
+static void scan_avx2(CountState *state, const unsigned char *data, size_t length) {
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+
+    for (; i + 64 <= length; i += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(data + i + 32));
+
+        uint64_t newlines = avx2_mask(v0, v1, lf);
+        uint64_t blank = newlines | avx2_mask(v0, v1, space) | avx2_mask(v0, v1, tab)
+                       | avx2_mask(v0, v1, cr);
+        scan_masks(state, newlines, ~blank);
+    }
+
+    scan_scalar(state, data + i, length - i);
+}
+
+static int always_supported() {
+    return 1;
+}
+
+static int avx2_supported() {
+    return __builtin_cpu_supports("avx2");
+}
+
+static const Variant variants[] = {
+    {"read-scalar", 0, scan_scalar, always_supported},
+    {"read-sse2",   0, scan_sse2,   always_supported},
+    {"read-avx2",   0, scan_avx2,   avx2_supported},
+    {"mmap-scalar", 1, scan_scalar, always_supported},
+    {"mmap-sse2",   1, scan_sse2,   always_supported},
+    {"mmap-avx2",   1, scan_avx2,   avx2_supported},
+};
+
+#define VARIANT_COUNT (sizeof(variants) / sizeof(variants[0]))
+
+static long long count_with_read(const char *path, scan_fn scan, unsigned char *buffer) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    CountState state = {0, 0};
+    ssize_t bytes_read;
+
+    while ((bytes_read = read(fd, buffer, READ_BUFFER_SIZE)) != 0) {
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        scan(&state, buffer, bytes_read);
+    }
+
+    close(fd);
+    return state.count + state.in_name;
+}
+
+static long long count_with_mmap(const char *path, scan_fn scan) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    CountState state = {0, 0};
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        scan(&state, data, st.st_size);
+        munmap(data, st.st_size);
+    }
+
+    close(fd);
+    return state.count + state.in_name;
+}
+
+// run the count_names binary on one file and parse the count it prints
+static long long count_with_binary(const char *binary, const char *path) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0) {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execl(binary, binary, path, (char *)NULL);
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+    char output[4096];
+    size_t used = 0;
+    ssize_t n;
+    while ((n = read(pipe_fds[0], output + used, sizeof(output) - 1 - used)) > 0) {
+        used += n;
+    }
+    output[used] = '\0';
+    close(pipe_fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+
+    // output is "<path>: <count>"
+    char *colon = strrchr(output, ':');
+    if (!colon) {
+        return -1;
+    }
+    return strtoll(colon + 1, NULL, 10);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [-b BINARY] [-r RUNS] [-t MIN_GBPS] FILE...\n"
+            "  -b BINARY   count_names binary to check (default ./count_names if present)\n"
+            "  -r RUNS     timed runs per variant, best is reported (default %d)\n"
+            "  -t GBPS     fail if any variant, count_names included, is slower than this\n"
+            "              (checked on files of 16 MiB or more)\n",
+            program, DEFAULT_RUNS);
+}
+
+int main(int argc, char *argv[]) {
+    const char *binary = NULL;
+    int runs = DEFAULT_RUNS;
+    double min_gbps = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:r:t:h")) != -1) {
+        switch (opt) {
+            case 'b':
+                binary = optarg;
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                if (runs < 1) {
+                    runs = 1;
+                }
+                break;
+            case 't':
+                min_gbps = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!binary && access("./count_names", X_OK) == 0) {
+        binary = "./count_names";
+    }
+
+    unsigned char *buffer;
+    if (posix_memalign((void **)&buffer, 4096, READ_BUFFER_SIZE) != 0) {
+        perror("Error allocating read buffer");
+        return 1;
+    }
+
+    // process startup is charged to every count_names run; measure it on
+    // an empty input so the binary's throughput reflects the counting alone
+    double startup = 0;
+    if (binary) {
+        for (int r = 0; r < runs; r++) {
+            double start = now_seconds();
+            count_with_binary(binary, "/dev/null");
+            double elapsed = now_seconds() - start;
+            if (r == 0 || elapsed < startup) {
+                startup = elapsed;
+            }
+        }
+        printf("count_names startup: %.4f s (subtracted from its timings)\n", startup);
+    }
+
+    int failures = 0;
+
+    for (int f = optind; f < argc; f++) {
+        const char *path = argv[f];
+        struct stat st;
+        if (stat(path, &st) < 0) {
+            perror(path);
+            failures++;
+            continue;
+        }
+
+        long long expected = reference_count(path);
+        if (expected < 0) {
+            fprintf(stderr, "%s: reference count failed\n", path);
+            failures++;
+            continue;
+        }
+
+        printf("%s (%.3f GB): reference %lld names\n", path, st.st_size / 1e9, expected);
+        printf("  %-12s %14s %10s %8s  %s\n", "variant", "names", "best s", "GB/s", "status");
+
+        for (size_t v = 0; v <= VARIANT_COUNT; v++) {
+            int is_binary = v == VARIANT_COUNT;
+            const char *name = is_binary ? "count_names" : variants[v].name;
+
+            if (is_binary ? binary == NULL : !variants[v].supported()) {
+                printf("  %-12s %14s %10s %8s  skipped\n", name, "-", "-", "-");
+                continue;
+            }
+
+            double best = 0;
+            long long result = -1;
+            for (int r = 0; r < runs; r++) {
+                double start = now_seconds();
+                if (is_binary) {
+                    result = count_with_binary(binary, path);
+                } else if (variants[v].use_mmap) {
+                    result = count_with_mmap(path, variants[v].scan);
+                } else {
+                    result = count_with_read(path, variants[v].scan, buffer);
+                }
+                double elapsed = now_seconds() - start;
+                if (r == 0 || elapsed < best) {
+                    best = elapsed;
+                }
+            }
+
+            if (is_binary) {
+                best = best > startup ? best - startup : 0;
+            }
+
+            double gbps = best > 0 ? st.st_size / 1e9 / best : 0;
+            const char *status = "ok";
+            if (result != expected) {
+                status = "MISMATCH";
+                failures++;
+            } else if (min_gbps > 0 && st.st_size >= FLOOR_MIN_SIZE && gbps < min_gbps) {
+                status = "SLOW";
+                failures++;
+            }
+
+            printf("  %-12s %14lld %10.4f %8.2f  %s\n", name, result, best, gbps, status);
+        }
+    }
+
+    free(buffer);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
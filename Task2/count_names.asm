@@ -1,210 +1,354 @@
-; Program to count non-empty names in a file
-; Ignores empty lines
+; Program to count non-empty names in files or standard input
+; Ignores empty lines and lines containing only spaces, tabs or carriage returns
+;
+; Usage:
+;   count_names                 read names from standard input
+;   count_names FILE...         count each file, then print a total
+;   A FILE of "-" also reads from standard input
 
 section .data
-    filename db "names.txt", 0       ; File containing names
-    countMsg db "Number of names: ", 0
-    errorMsg db "Error opening file", 10, 0
-    
     LF equ 10                        ; Line feed character
+    TAB equ 9                        ; Tab character
+    CR equ 13                        ; Carriage return, blank in CRLF files
     NULL equ 0                       ; End of string
-    
+
+    countMsg db "Number of names: ", 0
+    totalMsg db "Total names: ", 0
+    separatorMsg db ": ", 0
+    errorMsg db "Error opening file: ", 0
+    readErrorMsg db "Error reading file: ", 0
+    stdinName db "-", 0
+    newlineMsg db LF, 0
+
     ; System call constants
     SYS_read equ 0
     SYS_write equ 1
     SYS_open equ 2
     SYS_close equ 3
+    SYS_fcntl equ 72
+    SYS_fadvise64 equ 221
     SYS_exit equ 60
-    
+
+    STDIN equ 0
     STDOUT equ 1
+    STDERR equ 2
     O_RDONLY equ 0                   ; Read only flag
+    EINTR equ 4
+
+    F_SETPIPE_SZ equ 1031            ; Grow a pipe so the writer can run ahead
+    POSIX_FADV_SEQUENTIAL equ 2      ; Ask for aggressive readahead
+
+    BUFFER_SIZE equ 1048576          ; 1 MiB per read() keeps syscalls rare
 
 section .bss
+    alignb 4096
+    buffer resb BUFFER_SIZE          ; Page-aligned buffer for file reading
     fileDesc resq 1                  ; File descriptor
-    buffer resb 4096                 ; Buffer for file reading
-    nameCount resq 1                 ; Counter for names
+    fileCount resq 1                 ; Names in the current file
+    totalCount resq 1                ; Names across all files
+    exitStatus resq 1                ; 1 if any file could not be read
 
 section .text
     global _start
 
 _start:
-    ; Initialize name counter
-    mov qword [nameCount], 0
-    
-    ; Open the file
+    ; Initialize counters
+    mov qword [totalCount], 0
+    mov qword [exitStatus], 0
+
+    mov r12, [rsp]                  ; r12 = argc
+    lea r13, [rsp+8]                ; r13 = argv
+
+    ; No arguments: count standard input
+    cmp r12, 1
+    jg processFiles
+
+    mov rdi, STDIN
+    call countFd
+
+    cmp rax, 0
+    jl stdinReadError
+
+    mov [fileCount], rax
+
+    ; Print message
+    mov rdi, countMsg
+    call printString
+
+    ; Print the count
+    mov rax, qword [fileCount]
+    call writeInteger
+    jmp exitProgram
+
+stdinReadError:
+    mov r14, stdinName
+    mov rdi, readErrorMsg
+    call printFileError
+    jmp exitProgram
+
+processFiles:
+    mov r15, 1                      ; r15 = index of current argument
+
+fileLoop:
+    cmp r15, r12
+    jge printTotal
+
+    mov r14, [r13+r15*8]            ; r14 = current filename
+
+    ; "-" means standard input, which must not be closed
+    cmp byte [r14], '-'
+    jne openFile
+    cmp byte [r14+1], NULL
+    jne openFile
+    mov qword [fileDesc], STDIN
+    jmp countFile
+
+openFile:
     mov rax, SYS_open
-    mov rdi, filename
+    mov rdi, r14
     mov rsi, O_RDONLY
     mov rdx, 0
     syscall
-    
+
     ; Check if file opened successfully
     cmp rax, 0
     jl errorOpeningFile
-    
+
     ; Store file descriptor
     mov [fileDesc], rax
-    
-    ; Initialize line tracking
+
+countFile:
+    mov rdi, qword [fileDesc]
+    call countFd
+    mov [fileCount], rax
+
+    ; Close the file unless it is standard input
+    cmp qword [fileDesc], STDIN
+    je checkFileCount
+    mov rax, SYS_close
+    mov rdi, qword [fileDesc]
+    syscall
+
+checkFileCount:
+    cmp qword [fileCount], 0
+    jl errorReadingFile
+
+    mov rax, qword [fileCount]
+    add qword [totalCount], rax
+
+    ; Print "<filename>: <count>"
+    mov rdi, r14
+    call printString
+    mov rdi, separatorMsg
+    call printString
+    mov rax, qword [fileCount]
+    call writeInteger
+    jmp nextFile
+
+errorOpeningFile:
+    mov rdi, errorMsg
+    call printFileError
+    jmp nextFile
+
+errorReadingFile:
+    mov rdi, readErrorMsg
+    call printFileError
+
+nextFile:
+    inc r15
+    jmp fileLoop
+
+printTotal:
+    ; A total is only useful when more than one file was given
+    cmp r12, 2
+    jle exitProgram
+
+    mov rdi, totalMsg
+    call printString
+    mov rax, qword [totalCount]
+    call writeInteger
+
+exitProgram:
+    mov rax, SYS_exit
+    mov rdi, qword [exitStatus]
+    syscall
+
+; Function to report "<message><filename>" on stderr and flag failure
+; rdi = message, r14 = filename
+printFileError:
+    mov rsi, STDERR
+    call printStringFd
+    mov rdi, r14
+    mov rsi, STDERR
+    call printStringFd
+    mov rdi, newlineMsg
+    mov rsi, STDERR
+    call printStringFd
+    mov qword [exitStatus], 1
+    ret
+
+; Function to count non-empty lines read from a file descriptor
+; rdi = file descriptor
+; Returns the number of names in rax, or -1 if a read failed
+countFd:
+    push r12
+    push r13
+
+    mov r12, rdi                    ; r12 = file descriptor
+    xor r13, r13                    ; r13 = names counted so far
     xor r8, r8                      ; r8 = 0 (empty line flag: 0=empty, 1=non-empty)
-    
-readLoop:
+
+    ; Hint the kernel about our access pattern; both calls fail
+    ; harmlessly when the descriptor is not a pipe / regular file
+    mov rax, SYS_fcntl
+    mov rdi, r12
+    mov rsi, F_SETPIPE_SZ
+    mov rdx, BUFFER_SIZE
+    syscall
+
+    mov rax, SYS_fadvise64
+    mov rdi, r12
+    xor rsi, rsi
+    xor rdx, rdx
+    mov r10, POSIX_FADV_SEQUENTIAL
+    syscall
+
+countReadLoop:
     ; Read from file
     mov rax, SYS_read
-    mov rdi, qword [fileDesc]
+    mov rdi, r12
     mov rsi, buffer
-    mov rdx, 4096
+    mov rdx, BUFFER_SIZE
     syscall
-    
+
+    ; Retry reads interrupted by a signal
+    cmp rax, -EINTR
+    je countReadLoop
+
     ; Check if end of file (rax = 0) or error (rax < 0)
     cmp rax, 0
-    jle endReadLoop
-    
+    je countEndOfInput
+    jl countReadError
+
     ; Process buffer to count names (non-empty lines)
-    mov rcx, 0                      ; Initialize buffer index
-    
+    mov rsi, buffer                 ; rsi = current character
+    lea rcx, [buffer+rax]           ; rcx = end of data read
+
 countNamesLoop:
-    cmp rcx, rax                    ; Check if we've processed all bytes read
-    jge readLoopContinue            ; If yes, read more from file
-    
-    mov bl, byte [buffer+rcx]       ; Get current character
-    
+    cmp rsi, rcx                    ; Check if we've processed all bytes read
+    jae countReadLoop               ; If yes, read more from file
+
+    movzx eax, byte [rsi]           ; Get current character
+    inc rsi
+
     ; Check if current character is a newline
-    cmp bl, LF
-    jne notNewline
-    
-    ; Found a newline, check if line had content
-    cmp r8, 1                       ; Was the line non-empty?
-    jne skipEmptyLine               ; If empty, don't count it
-    
-    ; Line had content, increment name counter
-    inc qword [nameCount]
-    
-skipEmptyLine:
-    ; Reset line content flag for next line
-    xor r8, r8                      ; Mark new line as empty
-    jmp nextChar
-    
-notNewline:
-    ; Check if character is whitespace (space, tab)
-    cmp bl, ' '
-    je nextChar
-    cmp bl, 9                       ; Tab character
-    je nextChar
-    
+    cmp al, LF
+    je countLineEnd
+
+    ; Check if character is whitespace (space, tab, carriage return)
+    cmp al, ' '
+    je countNamesLoop
+    cmp al, TAB
+    je countNamesLoop
+    cmp al, CR
+    je countNamesLoop
+
     ; Non-whitespace character found, mark line as non-empty
     mov r8, 1
-    
-nextChar:
-    inc rcx                         ; Move to next character
     jmp countNamesLoop
-    
-readLoopContinue:
-    ; Continue reading from file
-    jmp readLoop
-    
-endReadLoop:
-    ; Check if the last line had content but no final newline
-    cmp r8, 1
-    jne skipLastLine
-    inc qword [nameCount]
-    
-skipLastLine:
-    ; Close the file
-    mov rax, SYS_close
-    mov rdi, qword [fileDesc]
-    syscall
-    
-    ; Print message
-    mov rdi, countMsg
-    call printString
-    
-    ; Print the count
-    mov rax, qword [nameCount]
-    call writeInteger
-    
-    ; Exit program
-    mov rax, SYS_exit
-    mov rdi, 0
-    syscall
-    
-errorOpeningFile:
-    ; Print error message
-    mov rdi, errorMsg
-    call printString
-    
-    ; Exit with error code
-    mov rax, SYS_exit
-    mov rdi, 1
-    syscall
-    
-; Function to print a null-terminated string
+
+countLineEnd:
+    ; Count the line if it had content, then start a new empty line
+    add r13, r8
+    xor r8, r8
+    jmp countNamesLoop
+
+countEndOfInput:
+    ; Count the last line if it had content but no final newline
+    add r13, r8
+    mov rax, r13
+    jmp countDone
+
+countReadError:
+    mov rax, -1
+
+countDone:
+    pop r13
+    pop r12
+    ret
+
+; Function to print a null-terminated string to stdout
+; rdi = string
 printString:
+    mov rsi, STDOUT
+
+; Function to print a null-terminated string to a file descriptor
+; rdi = string, rsi = file descriptor
+printStringFd:
     push rbx
     mov rbx, rdi
     mov rdx, 0                      ; Counter for string length
-    
+
 strCountLoop:
     cmp byte [rbx], NULL
     je strCountDone
     inc rdx
     inc rbx
     jmp strCountLoop
-    
+
 strCountDone:
     cmp rdx, 0
     je prtDone
-    
+
     mov rax, SYS_write
-    mov rsi, rdi                    ; Address of string
-    mov rdi, STDOUT
+    xchg rsi, rdi                   ; rsi = address of string, rdi = fd
     syscall
-    
+
 prtDone:
     pop rbx
     ret
-    
+
 ; Function to write an integer to console
+; rax = value
 writeInteger:
     push rbp
     mov rbp, rsp
-    sub rsp, 16                     ; Allocate buffer on stack
-    
+    push rbx
+    sub rsp, 24                     ; Buffer for up to 20 digits and a terminator
+
     mov rcx, 10                     ; Divisor for base 10
-    mov rbx, rsp                    ; Point to buffer
-    add rbx, 15                     ; Start at end of buffer
+    lea rbx, [rbp-9]                ; Start at end of buffer
     mov byte [rbx], 0               ; Null terminator
     dec rbx
-    
+
     ; Handle zero case
     cmp rax, 0
     jne convertLoop
     mov byte [rbx], '0'
     dec rbx
     jmp printNumber
-    
+
 convertLoop:
     cmp rax, 0
     je printNumber
-    
+
     xor rdx, rdx                    ; Clear rdx for division
     div rcx                         ; Divide rax by 10, remainder in rdx
     add dl, '0'                     ; Convert remainder to ASCII
     mov [rbx], dl                   ; Store digit
     dec rbx                         ; Move buffer pointer
     jmp convertLoop
-    
+
 printNumber:
     inc rbx                         ; Adjust pointer to first digit
     mov rdi, rbx
     call printString
-    
+
     ; Print newline
-    mov rdi, rsp
-    mov byte [rdi], LF
-    mov byte [rdi+1], NULL
+    mov rdi, newlineMsg
     call printString
-    
+
+    mov rbx, [rbp-8]
     mov rsp, rbp
     pop rbp
     ret
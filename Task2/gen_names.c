@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#define OUT_BUFFER_SIZE (1 << 20)
+#define MAX_LINE 256
+
+// generates a synthetic corpus of names for count_names
+//
+// the mix covers everything the counter has to get right: variable
+// line lengths, CRLF endings, empty and whitespace-only lines, UTF-8
+// names and (by default) a final line with no trailing newline
+
+static const char *first_names[] = {
+    "John", "Sarah", "Elizabeth", "Frida", "Chidi", "Amara", "Kwame",
+    "Zoë", "José", "Björn", "Ngozi", "Siobhán", "Łukasz", "Ifeoma",
+    "Mikhail", "Renée", "Tunde", "Aisling", "Dvořák", "Müller"
+};
+
+static const char *last_names[] = {
+    "Doe", "matin", "gates", "Okafor", "Mensah", "Nakamura", "Chukwudi",
+    "García", "O'Brien", "Sørensen", "Ivanov", "Adeyemi", "Øyelaran",
+    "Schäfer", "Nguyễn", "Kowalski", "Achebe", "Fernández"
+};
+
+static const char *utf8_names[] = {
+    "山田 太郎", "Александр Пушкин", "Ὅμηρος", "محمد علي", "김민준", "Έλενα"
+};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random() {
+    // xorshift64*, deterministic for a given seed
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static unsigned random_below(unsigned n) {
+    return (unsigned)(next_random() % n);
+}
+
+// parse sizes such as 1048576, 512K, 1M, 10G
+static int parse_size(const char *text, uint64_t *size) {
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno != 0 || end == text) {
+        return -1;
+    }
+
+    switch (*end) {
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: break;
+    }
+    if (*end == 'B' || *end == 'b') {
+        end++;
+    }
+    if (*end != '\0') {
+        return -1;
+    }
+
+    *size = value;
+    return 0;
+}
+
+static void append(char *line, int *length, const char *text) {
+    int n = strlen(text);
+    if (*length + n < MAX_LINE) {
+        memcpy(line + *length, text, n);
+        *length += n;
+    }
+}
+
+static void append_whitespace(char *line, int *length, int max) {
+    int n = random_below(max + 1);
+    for (int i = 0; i < n && *length < MAX_LINE; i++) {
+        line[(*length)++] = random_below(2) ? ' ' : '\t';
+    }
+}
+
+// build one line (including its terminator) and return its length
+static int make_line(char *line, int crlf_percent) {
+    int length = 0;
+    unsigned kind = random_below(100);
+
+    if (kind < 8) {
+        // empty line
+    } else if (kind < 16) {
+        // whitespace-only line
+        append_whitespace(line, &length, 8);
+        if (length == 0) {
+            line[length++] = ' ';
+        }
+    } else if (kind < 24) {
+        append_whitespace(line, &length, 3);
+        append(line, &length, utf8_names[random_below(COUNT(utf8_names))]);
+        append_whitespace(line, &length, 3);
+    } else {
+        // leading/trailing whitespace and 1-4 name parts give variable lengths
+        if (random_below(10) == 0) {
+            append_whitespace(line, &length, 4);
+        }
+        int parts = 1 + random_below(4);
+        for (int i = 0; i < parts; i++) {
+            if (i > 0) {
+                append(line, &length, " ");
+            }
+            if (i == parts - 1 && parts > 1) {
+                append(line, &length, last_names[random_below(COUNT(last_names))]);
+            } else {
+                append(line, &length, first_names[random_below(COUNT(first_names))]);
+            }
+        }
+        if (random_below(10) == 0) {
+            append_whitespace(line, &length, 4);
+        }
+    }
+
+    if ((int)random_below(100) < crlf_percent) {
+        line[length++] = '\r';
+    }
+    line[length++] = '\n';
+    return length;
+}
+
+static int write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        length -= written;
+    }
+    return 0;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [-s SIZE] [-o FILE] [-S SEED] [-c CRLF%%] [-n]\n"
+            "  -s SIZE   approximate output size, e.g. 1M, 512M, 10G (default 1M)\n"
+            "  -o FILE   output file (default stdout)\n"
+            "  -S SEED   random seed (default 1)\n"
+            "  -c PCT    percentage of CRLF line endings (default 10)\n"
+            "  -n        keep the trailing newline on the last line\n",
+            program);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t target_size = 1 << 20;
+    const char *output = NULL;
+    unsigned long long seed = 1;
+    int crlf_percent = 10;
+    int keep_final_newline = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:o:S:c:nh")) != -1) {
+        switch (opt) {
+            case 's':
+                if (parse_size(optarg, &target_size) < 0) {
+                    fprintf(stderr, "Invalid size: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'S':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'c':
+                crlf_percent = atoi(optarg);
+                break;
+            case 'n':
+                keep_final_newline = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // xorshift must never be seeded with zero
+    rng_state ^= seed * 0xD1B54A32D192ED03ULL;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+
+    int fd = STDOUT_FILENO;
+    if (output) {
+        fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror("Error opening output file");
+            return 1;
+        }
+    }
+
+    char *buffer = malloc(OUT_BUFFER_SIZE);
+    if (!buffer) {
+        perror("Error allocating output buffer");
+        return 1;
+    }
+
+    uint64_t written = 0;
+    size_t used = 0;
+    char line[MAX_LINE + 2];
+    int last_line = 0;
+
+    while (!last_line && written + used < target_size) {
+        int length = make_line(line, crlf_percent);
+
+        // the last line is cut off before its line ending; stop after it
+        // even if that leaves the output a byte or two under the target
+        if (written + used + length >= target_size) {
+            last_line = 1;
+            if (!keep_final_newline) {
+                length -= (length >= 2 && line[length - 2] == '\r') ? 2 : 1;
+                if (length == 0) {
+                    line[length++] = 'X';
+                }
+            }
+        }
+
+        if (used + length > OUT_BUFFER_SIZE) {
+            if (write_all(fd, buffer, used) < 0) {
+                perror("Error writing output");
+                return 1;
+            }
+            written += used;
+            used = 0;
+        }
+        memcpy(buffer + used, line, length);
+        used += length;
+    }
+
+    if (write_all(fd, buffer, used) < 0) {
+        perror("Error writing output");
+        return 1;
+    }
+
+    free(buffer);
+    if (output) {
+        close(fd);
+    }
+    return 0;
+}
@@ -11,21 +11,19 @@
 #define SERVER_IP "127.0.0.1"
 #define BUFFER_SIZE 1024
 
+// the server ends every message with '\n', so read it a line at a time
 void *receive_messages(void *arg) {
-    int socket = *(int *)arg;
+    FILE *server = (FILE *)arg;
     char buffer[BUFFER_SIZE];
 
     while (1) {
-        memset(buffer, 0, BUFFER_SIZE);
-        int bytes_received = recv(socket, buffer, BUFFER_SIZE, 0);
-
-        if (bytes_received <= 0) {
+        if (!fgets(buffer, BUFFER_SIZE, server)) {
             printf("Server disconnected\n");
             exit(1);
         }
 
-        printf("\n%s\n", buffer);
-        printf("Enter command(LIST/SEND username:message): ");
+        printf("\n%s", buffer);
+        printf("Enter command(LIST/STATS/SEND username:message): ");
         fflush(stdout);
     }
 
@@ -57,6 +55,13 @@ int main() {
         exit(1);
     }
 
+    // replies are read through stdio, which splits them into lines
+    FILE *server = fdopen(dup(client_socket), "r");
+    if (!server) {
+        perror("Error opening server stream");
+        exit(1);
+    }
+
     printf("Connected to server\n");
 
     while (1) {
@@ -64,36 +69,44 @@ int main() {
         fgets(username, 50, stdin);
         username[strcspn(username, "\n")] = 0;
 
-        send(client_socket, username, strlen(username), 0);
-        memset(buffer, 0, BUFFER_SIZE);
-        recv(client_socket, buffer, BUFFER_SIZE, 0);
+        // the server reads one message per line
+        int length = snprintf(buffer, BUFFER_SIZE, "%s\n", username);
+        send(client_socket, buffer, length, 0);
+        if (!fgets(buffer, BUFFER_SIZE, server)) {
+            printf("Server disconnected\n");
+            exit(1);
+        }
 
-        if (strncmp(buffer, "Authenticated", 13) == 0) {
+        if (strcmp(buffer, "Authenticated\n") == 0) {
             printf("Authentication successful\n");
             break;
         } else {
-            printf("Authentication failed: %s\n", buffer);
+            printf("Authentication failed: %s", buffer);
         }
     }
 
-    if (pthread_create(&receive_thread, NULL, receive_messages, &client_socket) != 0) {
+    if (pthread_create(&receive_thread, NULL, receive_messages, server) != 0) {
         perror("Error creating thread");
         exit(1);
     }
 
     while (1) {
-        printf("Enter command(LIST/SEND username:message): ");
+        printf("Enter command(LIST/STATS/SEND username:message): ");
         fgets(buffer, BUFFER_SIZE, stdin);
         buffer[strcspn(buffer, "\n")] = 0;
 
         if (strcmp(buffer, "LIST") == 0) {
-            send(client_socket, "LIST", 4, 0);
+            send(client_socket, "LIST\n", 5, 0);
+        } else if (strcmp(buffer, "STATS") == 0) {
+            send(client_socket, "STATS\n", 6, 0);
         } else if (strncmp(buffer, "SEND ", 5) == 0) {
             // Format should be: SEND username:message
             char *message_part = buffer + 5;
-            send(client_socket, message_part, strlen(message_part), 0);
+            size_t length = strlen(message_part);
+            message_part[length] = '\n';
+            send(client_socket, message_part, length + 1, 0);
         } else {
-            printf("Invalid command. Use LIST or SEND username:message\n");
+            printf("Invalid command. Use LIST, STATS or SEND username:message\n");
         }
     }
 
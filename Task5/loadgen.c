@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+
+#define PORT 8080
+#define SERVER_IP "127.0.0.1"
+#define BUFFER_SIZE 1024
+#define FLOOD_MESSAGE_SIZE 200
+#define REPLY_TIMEOUT_MS 1000
+
+// load generator for the chat server
+//
+// well-behaved clients send themselves a ping every interval and time the
+// round trip; abusive clients flood as fast as the server will take it,
+// either to themselves or (-t) to another user such as good0. Compare the
+// well-behaved latency percentiles with and without abusers (-a 0) to see
+// whether one chatty session hurts everyone else
+
+typedef struct {
+    int index;
+    int socket;
+    char username[50];
+    long long *latencies;       // round trips in microseconds
+    int latency_count;
+    int latency_capacity;
+    int timeouts;
+    long long sent;
+    char input[BUFFER_SIZE];    // replies received but not yet split into lines
+    int input_length;
+} LoadClient;
+
+int duration_seconds = 10;
+int interval_ms = 10;
+const char *flood_target = NULL;    // user the abusers flood; NULL for themselves
+volatile int running = 1;
+
+long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// read the next '\n'-terminated reply into line, without its terminator;
+// returns -1 on timeout or disconnect
+int read_line(LoadClient *client, char *line) {
+    while (1) {
+        char *newline = memchr(client->input, '\n', client->input_length);
+        if (newline) {
+            int length = newline - client->input;
+            memcpy(line, client->input, length);
+            line[length] = '\0';
+            client->input_length -= length + 1;
+            memmove(client->input, newline + 1, client->input_length);
+            return 0;
+        }
+
+        // the server never sends a line longer than the buffer; drop one if it does
+        if (client->input_length == BUFFER_SIZE) {
+            client->input_length = 0;
+        }
+
+        int bytes_received = recv(client->socket, client->input + client->input_length,
+                                  BUFFER_SIZE - client->input_length, 0);
+        if (bytes_received <= 0) {
+            return -1;
+        }
+        client->input_length += bytes_received;
+    }
+}
+
+int connect_client(LoadClient *client) {
+    struct sockaddr_in server_address;
+    char buffer[BUFFER_SIZE];
+
+    int client_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (client_socket == -1) {
+        perror("Error creating socket");
+        return -1;
+    }
+
+    server_address.sin_family = AF_INET;
+    server_address.sin_port = htons(PORT);
+    server_address.sin_addr.s_addr = inet_addr(SERVER_IP);
+
+    if (connect(client_socket, (struct sockaddr *)&server_address, sizeof(server_address)) < 0) {
+        perror("Error connecting to server");
+        close(client_socket);
+        return -1;
+    }
+    client->socket = client_socket;
+
+    // the server reads one message per line
+    int length = snprintf(buffer, BUFFER_SIZE, "%s\n", client->username);
+    send(client_socket, buffer, length, 0);
+
+    if (read_line(client, buffer) < 0 || strcmp(buffer, "Authenticated") != 0) {
+        fprintf(stderr, "Authentication failed for %s\n", client->username);
+        close(client_socket);
+        return -1;
+    }
+    return 0;
+}
+
+void *well_behaved_client(void *arg) {
+    LoadClient *client = (LoadClient *)arg;
+    char message[BUFFER_SIZE];
+    char reply[BUFFER_SIZE];
+    char expected[BUFFER_SIZE];
+
+    struct timeval timeout = {REPLY_TIMEOUT_MS / 1000, (REPLY_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client->socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    for (long long seq = 0; running; seq++) {
+        snprintf(message, BUFFER_SIZE, "%s:ping %lld\n", client->username, seq);
+        snprintf(expected, BUFFER_SIZE, "%s: ping %lld", client->username, seq);
+
+        long long start = now_us();
+        send(client->socket, message, strlen(message), MSG_NOSIGNAL);
+        client->sent++;
+
+        // wait for our own ping to come back; any other line is skipped
+        int matched = 0;
+        while (running && !matched) {
+            if (read_line(client, reply) < 0) {
+                break;
+            }
+            matched = strcmp(reply, expected) == 0;
+        }
+
+        if (matched && client->latency_count < client->latency_capacity) {
+            client->latencies[client->latency_count++] = now_us() - start;
+        } else if (!matched && running) {
+            client->timeouts++;
+        }
+
+        usleep(interval_ms * 1000);
+    }
+    return NULL;
+}
+
+void *abusive_reader(void *arg) {
+    LoadClient *client = (LoadClient *)arg;
+    char buffer[BUFFER_SIZE];
+
+    while (running && recv(client->socket, buffer, BUFFER_SIZE, 0) > 0) {
+    }
+    return NULL;
+}
+
+void *abusive_client(void *arg) {
+    LoadClient *client = (LoadClient *)arg;
+    char message[FLOOD_MESSAGE_SIZE + 1];
+    pthread_t reader;
+
+    // drain replies on another thread so the flood never stalls on them
+    pthread_create(&reader, NULL, abusive_reader, client);
+
+    int length = snprintf(message, sizeof(message), "%s:",
+                          flood_target ? flood_target : client->username);
+    memset(message + length, 'x', FLOOD_MESSAGE_SIZE - length);
+    message[FLOOD_MESSAGE_SIZE - 1] = '\n';
+    message[FLOOD_MESSAGE_SIZE] = '\0';
+
+    while (running) {
+        if (send(client->socket, message, FLOOD_MESSAGE_SIZE, MSG_NOSIGNAL) <= 0) {
+            break;
+        }
+        client->sent++;
+    }
+
+    shutdown(client->socket, SHUT_RDWR);
+    pthread_join(reader, NULL);
+    return NULL;
+}
+
+int compare_latencies(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+long long percentile(long long *sorted, int count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    int index = (int)(p / 100.0 * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+int main(int argc, char *argv[]) {
+    int good = 2;
+    int abusers = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:a:d:i:t:h")) != -1) {
+        switch (opt) {
+            case 'g': good = atoi(optarg); break;
+            case 'a': abusers = atoi(optarg); break;
+            case 'd': duration_seconds = atoi(optarg); break;
+            case 'i': interval_ms = atoi(optarg); break;
+            case 't': flood_target = optarg; break;
+            default:
+                fprintf(stderr,
+                        "Usage: %s [-g GOOD] [-a ABUSERS] [-d SECONDS] [-i INTERVAL_MS] [-t TARGET]\n"
+                        "  defaults: 2 well-behaved clients, 1 abuser, 10 s, 10 ms between pings\n"
+                        "  -t TARGET  abusers flood TARGET (e.g. good0) instead of themselves\n",
+                        argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int total = good + abusers;
+    LoadClient *clients = calloc(total, sizeof(LoadClient));
+    pthread_t *threads = calloc(total, sizeof(pthread_t));
+
+    for (int i = 0; i < total; i++) {
+        LoadClient *client = &clients[i];
+        client->index = i;
+        if (i < good) {
+            snprintf(client->username, sizeof(client->username), "good%d", i);
+            client->latency_capacity = duration_seconds * 1000 / (interval_ms > 0 ? interval_ms : 1) + 1;
+            client->latencies = malloc(client->latency_capacity * sizeof(long long));
+        } else {
+            snprintf(client->username, sizeof(client->username), "flood%d", i - good);
+        }
+
+        if (connect_client(client) < 0) {
+            return 1;
+        }
+    }
+
+    printf("Running %d well-behaved and %d abusive clients for %d s, flooding %s\n",
+           good, abusers, duration_seconds, flood_target ? flood_target : "themselves");
+    long long start = now_us();
+
+    for (int i = 0; i < total; i++) {
+        pthread_create(&threads[i], NULL, i < good ? well_behaved_client : abusive_client, &clients[i]);
+    }
+
+    sleep(duration_seconds);
+    running = 0;
+
+    for (int i = 0; i < total; i++) {
+        shutdown(clients[i].socket, SHUT_RDWR);
+        pthread_join(threads[i], NULL);
+        close(clients[i].socket);
+    }
+    double elapsed = (now_us() - start) / 1e6;
+
+    // merge the well-behaved round trips and report percentiles
+    int count = 0, timeouts = 0;
+    for (int i = 0; i < good; i++) {
+        count += clients[i].latency_count;
+        timeouts += clients[i].timeouts;
+    }
+    long long *all = malloc((count + 1) * sizeof(long long));
+    count = 0;
+    for (int i = 0; i < good; i++) {
+        memcpy(all + count, clients[i].latencies, clients[i].latency_count * sizeof(long long));
+        count += clients[i].latency_count;
+        free(clients[i].latencies);
+    }
+    qsort(all, count, sizeof(long long), compare_latencies);
+
+    printf("well-behaved: %d round trips, %d timed out\n", count, timeouts);
+    printf("  latency us: p50 %lld  p90 %lld  p99 %lld  p99.9 %lld  max %lld\n",
+           percentile(all, count, 50), percentile(all, count, 90), percentile(all, count, 99),
+           percentile(all, count, 99.9), count ? all[count - 1] : 0);
+
+    for (int i = good; i < total; i++) {
+        printf("%s: %lld messages sent (%.0f/s)\n", clients[i].username, clients[i].sent,
+               clients[i].sent / elapsed);
+    }
+
+    free(all);
+    free(clients);
+    free(threads);
+    return 0;
+}
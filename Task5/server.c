@@ -2,25 +2,229 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
-#include <pthread.h>
 
 #define PORT 8080
+#ifndef MAX_CLIENTS
 #define MAX_CLIENTS 4
+#endif
 #define BUFFER_SIZE 1024
-
-// client structure to track connections
-typedef struct {
+#define USERNAME_SIZE 50
+#define CACHE_LINE 64
+#define OUTPUT_QUEUE_BUFFERS 8          // replies a slow reader may have waiting
+#define BUFFERS_PER_CLIENT (2 + OUTPUT_QUEUE_BUFFERS)   // receiving, replies, output
+#define BUFFER_POOL_SIZE (MAX_CLIENTS * BUFFERS_PER_CLIENT)
+
+// per-session rate limit (token bucket, one token per message)
+#define RATE_LIMIT 200                  // messages per second
+#define RATE_BURST 50                   // messages allowed back to back
+
+// deficit round robin: byte credit a session earns per scheduler turn
+#define QUANTUM BUFFER_SIZE
+#define MAX_MESSAGES_PER_TURN 4
+
+// I/O buffer; the freelist link reuses the buffer's own storage
+typedef union IoBuffer {
+    union IoBuffer *next_free;
+    char data[BUFFER_SIZE];
+} IoBuffer;
+
+// client structure to track connections, one slab slot per session
+typedef struct Client {
     int socket;
-    char username[50];
     int is_authenticated;
-} Client;
+    char username[USERNAME_SIZE];
+    char *recv_buffer;                  // input, split into '\n'-terminated messages
+    size_t input_start;                 // first unconsumed byte of recv_buffer
+    size_t input_length;                // bytes of recv_buffer in use
+    int discarding;                     // dropping the rest of an oversized line
+    char *send_buffer;
+    char *output[OUTPUT_QUEUE_BUFFERS]; // messages waiting to be sent, oldest first
+    int output_length[OUTPUT_QUEUE_BUFFERS];
+    int output_count;                   // buffers in the output queue
+    int output_sent;                    // bytes of output[0] already sent
+    struct Client *next_free;
+    double tokens;                      // token bucket level
+    long long last_refill_us;
+    long deficit;                       // DRR byte credit for this turn
+    unsigned long shed;                 // messages dropped for this session
+} __attribute__((aligned(CACHE_LINE))) Client;
+
+// allocation counters
+typedef struct {
+    unsigned long clients_allocated;
+    unsigned long clients_released;
+    unsigned long buffers_acquired;
+    unsigned long buffers_released;
+    unsigned long messages_routed;
+    unsigned long message_path_allocations;
+} PoolStats;
+
+// scheduler counters
+typedef struct {
+    unsigned long throttled;            // turns skipped for lack of tokens
+    unsigned long quantum_exhausted;    // turns cut short by the DRR quantum
+    unsigned long messages_shed;        // oversized lines and sends to full queues
+} SchedulerStats;
 
 // global variables
+// all session memory is reserved up front: the client slab and the
+// buffer pool are fixed arrays handed out through freelists, so the
+// message path never touches the general-purpose heap
 Client clients[MAX_CLIENTS];
-pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
+Client *free_clients = NULL;
+
+IoBuffer buffer_pool[BUFFER_POOL_SIZE] __attribute__((aligned(CACHE_LINE)));
+IoBuffer *free_buffers = NULL;
+
+PoolStats pool_stats;
+SchedulerStats scheduler_stats;
+
+// calls into the general-purpose heap, counted by the malloc/calloc/realloc
+// wrappers below; they also see allocations made inside libc itself
+unsigned long heap_allocations = 0;
+
+// glibc's own allocator entry points, used by the counting wrappers
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    heap_allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    heap_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    heap_allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void set_nonblocking(int socket) {
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+}
+
+void initialize_pools() {
+    for (int i = MAX_CLIENTS - 1; i >= 0; i--) {
+        clients[i].socket = -1;
+        clients[i].is_authenticated = 0;
+        strcpy(clients[i].username, "");
+        clients[i].output_count = 0;
+        clients[i].next_free = free_clients;
+        free_clients = &clients[i];
+    }
+
+    for (int i = BUFFER_POOL_SIZE - 1; i >= 0; i--) {
+        buffer_pool[i].next_free = free_buffers;
+        free_buffers = &buffer_pool[i];
+    }
+}
+
+char *buffer_acquire() {
+    IoBuffer *buffer = free_buffers;
+    if (buffer) {
+        free_buffers = buffer->next_free;
+        pool_stats.buffers_acquired++;
+    }
+    return buffer ? buffer->data : NULL;
+}
+
+void buffer_release(char *data) {
+    if (!data) {
+        return;
+    }
+    IoBuffer *buffer = (IoBuffer *)data;
+    buffer->next_free = free_buffers;
+    free_buffers = buffer;
+    pool_stats.buffers_released++;
+}
+
+void client_release(Client *client);
+
+// take a free slab slot and its I/O buffers; NULL when the server is full
+Client *client_alloc(int client_socket) {
+    Client *client = free_clients;
+    if (!client) {
+        return NULL;
+    }
+    free_clients = client->next_free;
+    client->socket = client_socket;
+    client->is_authenticated = 0;
+    strcpy(client->username, "");
+    client->tokens = RATE_BURST;
+    client->last_refill_us = now_us();
+    client->deficit = 0;
+    client->shed = 0;
+    client->input_start = 0;
+    client->input_length = 0;
+    client->discarding = 0;
+    client->output_count = 0;
+    client->output_sent = 0;
+    pool_stats.clients_allocated++;
+
+    client->recv_buffer = buffer_acquire();
+    client->send_buffer = buffer_acquire();
+    if (!client->recv_buffer || !client->send_buffer) {
+        client_release(client);
+        return NULL;
+    }
+    return client;
+}
+
+void client_release(Client *client) {
+    buffer_release(client->recv_buffer);
+    buffer_release(client->send_buffer);
+    client->recv_buffer = NULL;
+    client->send_buffer = NULL;
+    for (int i = 0; i < client->output_count; i++) {
+        buffer_release(client->output[i]);
+    }
+    client->output_count = 0;
+
+    client->socket = -1;
+    client->is_authenticated = 0;
+    strcpy(client->username, "");
+    client->next_free = free_clients;
+    free_clients = client;
+    pool_stats.clients_released++;
+}
+
+// most memory a session can hold: slab slot and buffers, with a full output queue
+size_t session_memory() {
+    return sizeof(Client) + BUFFERS_PER_CLIENT * sizeof(IoBuffer);
+}
+
+void format_stats(char *out, size_t size) {
+    snprintf(out, size,
+             "Sessions: %lu/%d in use, %zu bytes each; buffers: %lu/%d in use; "
+             "pool allocations: %lu; heap allocations: %lu; messages routed: %lu; "
+             "message-path heap allocations: %lu; "
+             "throttled: %lu; quantum exhausted: %lu; shed: %lu",
+             pool_stats.clients_allocated - pool_stats.clients_released, MAX_CLIENTS,
+             session_memory(),
+             pool_stats.buffers_acquired - pool_stats.buffers_released, BUFFER_POOL_SIZE,
+             pool_stats.clients_allocated + pool_stats.buffers_acquired, heap_allocations,
+             pool_stats.messages_routed, pool_stats.message_path_allocations,
+             scheduler_stats.throttled, scheduler_stats.quantum_exhausted,
+             scheduler_stats.messages_shed);
+}
 
 int setup_server() {
     int server_socket;
@@ -57,205 +261,429 @@ int setup_server() {
         exit(1);
     }
 
+    set_nonblocking(server_socket);
+
     printf("Server listening on port %d\n", PORT);
     return server_socket;
 }
 
-int authenticate_client(int client_socket, char *username) {
-    pthread_mutex_lock(&clients_mutex);
+// count a message from this session that was dropped instead of delivered
+void shed_message(Client *sender) {
+    sender->shed++;
+    scheduler_stats.messages_shed++;
+}
+
+// return the head of the output queue to the pool once it is sent
+void output_pop(Client *client) {
+    buffer_release(client->output[0]);
+    client->output_count--;
+    memmove(client->output, client->output + 1, client->output_count * sizeof(client->output[0]));
+    memmove(client->output_length, client->output_length + 1,
+            client->output_count * sizeof(client->output_length[0]));
+    client->output_sent = 0;
+}
+
+// send as much of the output queue as the socket takes without blocking;
+// the rest goes out when poll reports the socket writable
+void flush_output(Client *client) {
+    while (client->output_count > 0) {
+        ssize_t sent = send(client->socket, client->output[0] + client->output_sent,
+                            client->output_length[0] - client->output_sent,
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                // the connection is gone: nothing queued will be delivered,
+                // and the I/O loop disconnects the session
+                while (client->output_count > 0) {
+                    output_pop(client);
+                }
+            }
+            return;
+        }
+
+        client->output_sent += sent;
+        if (client->output_sent < client->output_length[0]) {
+            return;
+        }
+        output_pop(client);
+    }
+}
+
+// queue one message for the target, terminated with '\n' so readers can
+// split the stream, and start sending it. a slow reader never blocks the
+// I/O loop: once its output queue is full, further messages to it are
+// shed and charged to the sender, and the reader keeps its connection
+void send_message(Client *sender, Client *target, const char *message, size_t length) {
+    int last = target->output_count - 1;
+
+    if (last < 0 || target->output_length[last] + length + 1 > BUFFER_SIZE) {
+        char *buffer = target->output_count < OUTPUT_QUEUE_BUFFERS ? buffer_acquire() : NULL;
+        if (!buffer) {
+            shed_message(sender);
+            return;
+        }
+        last = target->output_count++;
+        target->output[last] = buffer;
+        target->output_length[last] = 0;
+    }
+
+    char *end = target->output[last] + target->output_length[last];
+    memcpy(end, message, length);
+    end[length] = '\n';
+    target->output_length[last] += length + 1;
+
+    flush_output(target);
+}
+
+int authenticate_client(Client *client, char *username) {
+    // reject names that would not fit in the slab slot
+    if (username[0] == '\0' || strlen(username) >= USERNAME_SIZE) {
+        return 0;
+    }
 
     // Check if username already exists
     for (int i = 0; i < MAX_CLIENTS; i++) {
         if (clients[i].is_authenticated &&
             strcmp(clients[i].username, username) == 0) {
-            pthread_mutex_unlock(&clients_mutex);
             return 0;
         }
     }
 
-    // Find an empty slot
+    strcpy(client->username, username);
+    client->is_authenticated = 1;
+    return 1;
+}
+
+Client *find_client_by_username(const char *username) {
     for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i].socket == client_socket) {
-            strcpy(clients[i].username, username);
-            clients[i].is_authenticated = 1;
-            pthread_mutex_unlock(&clients_mutex);
-            return 1;
+        if (clients[i].is_authenticated &&
+            strcmp(clients[i].username, username) == 0) {
+            return &clients[i];
         }
     }
 
-    pthread_mutex_unlock(&clients_mutex);
-    return 0;
+    return NULL;
 }
 
-int find_client_by_username(const char *username) {
-    pthread_mutex_lock(&clients_mutex);
+void broadcast_online_clients(Client *sender) {
+    char *online_clients = sender->send_buffer;
+    size_t length = snprintf(online_clients, BUFFER_SIZE, "Online clients: ");
 
     for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i].is_authenticated &&
-            strcmp(clients[i].username, username) == 0) {
-            int client_socket = clients[i].socket;
-            pthread_mutex_unlock(&clients_mutex);
-            return client_socket;
+        if (clients[i].is_authenticated && length < BUFFER_SIZE) {
+            length += snprintf(online_clients + length, BUFFER_SIZE - length,
+                               "%s, ", clients[i].username);
         }
     }
-    
-    pthread_mutex_unlock(&clients_mutex);
-    return -1;
+
+    send_message(sender, sender, online_clients, strlen(online_clients));
 }
 
-void broadcast_online_clients(int sender_socket) {
-    char online_clients[BUFFER_SIZE] = "Online clients: ";
-    pthread_mutex_lock(&clients_mutex);
+// length of the next complete message (including its '\n'), 0 if none
+size_t pending_line_length(const Client *client) {
+    const char *start = client->recv_buffer + client->input_start;
+    const char *newline = memchr(start, '\n', client->input_length - client->input_start);
+    return newline ? (size_t)(newline - start) + 1 : 0;
+}
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i].is_authenticated) {
-            strcat(online_clients, clients[i].username);
-            strcat(online_clients, ", ");
-        }
+// consume the next complete message, NUL-terminated in place
+char *take_line(Client *client, size_t length) {
+    char *line = client->recv_buffer + client->input_start;
+    line[length - 1] = '\0';
+
+    // Remove carriage return if present
+    if (length > 1 && line[length - 2] == '\r') {
+        line[length - 2] = '\0';
     }
+    client->input_start += length;
+    return line;
+}
+
+// append what the socket has after any partial message already buffered
+int receive_input(Client *client) {
+    char *buffer = client->recv_buffer;
+
+    // move the unfinished message to the front to make room
+    if (client->input_start > 0) {
+        client->input_length -= client->input_start;
+        memmove(buffer, buffer + client->input_start, client->input_length);
+        client->input_start = 0;
+    }
+
+    // a message that fills the whole buffer can never be routed: drop it
+    // and skip ahead to the start of the next one
+    if (client->input_length == BUFFER_SIZE) {
+        client->input_length = 0;
+        client->discarding = 1;
+        shed_message(client);
+    }
+
+    int bytes_received = recv(client->socket, buffer + client->input_length,
+                              BUFFER_SIZE - client->input_length, MSG_DONTWAIT);
+    if (bytes_received <= 0) {
+        return bytes_received;
+    }
+    client->input_length += bytes_received;
 
-    pthread_mutex_unlock(&clients_mutex);
-    send(sender_socket, online_clients, strlen(online_clients), 0);
+    if (client->discarding) {
+        char *newline = memchr(buffer, '\n', client->input_length);
+        if (newline) {
+            client->input_start = newline - buffer + 1;
+            client->discarding = 0;
+        } else {
+            client->input_length = 0;
+        }
+    }
+    return bytes_received;
 }
 
-void *handle_client(void *arg) {
-    int *socket_ptr = (int *)arg;
-    int client_socket = *socket_ptr;
-    free(socket_ptr); // Free the allocated memory
-    
-    char buffer[BUFFER_SIZE];
-    char username[50] = "";
-    int is_authenticated = 0;
-
-    // Register client in array
-    pthread_mutex_lock(&clients_mutex);
-    int client_index = -1;
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (!clients[i].is_authenticated) {
-            clients[i].socket = client_socket;
-            clients[i].is_authenticated = 0; // Not authenticated yet
-            strcpy(clients[i].username, "");
-            client_index = i;
-            break;
+void route_message(Client *client, char *buffer) {
+    char *reply = client->send_buffer;
+
+    // Check if command is LIST
+    if (strcmp(buffer, "LIST") == 0) {
+        broadcast_online_clients(client);
+    } else if (strcmp(buffer, "STATS") == 0) {
+        format_stats(reply, BUFFER_SIZE);
+        send_message(client, client, reply, strlen(reply));
+    } else {
+        // Parse message format: username:message
+        char *target_username = strtok(buffer, ":");
+        char *message = strtok(NULL, "");
+
+        if (target_username && message) {
+            Client *target = find_client_by_username(target_username);
+
+            if (target) {
+                snprintf(reply, BUFFER_SIZE, "%s: %s", client->username, message);
+                send_message(client, target, reply, strlen(reply));
+            } else {
+                snprintf(reply, BUFFER_SIZE, "User %s not found or not online", target_username);
+                send_message(client, client, reply, strlen(reply));
+            }
+        } else {
+            send_message(client, client, "Invalid message format. Use username:message", 44);
         }
     }
-    pthread_mutex_unlock(&clients_mutex);
+}
 
-    if (client_index == -1) {
-        // No space for new client
-        close(client_socket);
-        return NULL;
+// top up the token bucket for the time elapsed since the last refill
+void refill_tokens(Client *client, long long now) {
+    client->tokens += (now - client->last_refill_us) * (RATE_LIMIT / 1e6);
+    if (client->tokens > RATE_BURST) {
+        client->tokens = RATE_BURST;
     }
+    client->last_refill_us = now;
+}
 
-    while (!is_authenticated) {
-        memset(buffer, 0, BUFFER_SIZE);
-        int bytes_received = recv(client_socket, buffer, BUFFER_SIZE, 0);
+// microseconds until a throttled session earns its next token
+long long throttle_delay(const Client *client) {
+    return (long long)((1.0 - client->tokens) * 1e6 / RATE_LIMIT) + 1;
+}
 
-        if (bytes_received <= 0) {
-            close(client_socket);
-            
-            pthread_mutex_lock(&clients_mutex);
-            clients[client_index].is_authenticated = 0;
-            pthread_mutex_unlock(&clients_mutex);
-            
-            return NULL;
-        }
+void disconnect_client(Client *client) {
+    close(client->socket);
+    if (client->is_authenticated) {
+        printf("Client %s disconnected (%lu messages shed)\n", client->username, client->shed);
+    }
+    client_release(client);
+}
 
-        // Remove newline if present
-        buffer[strcspn(buffer, "\n")] = 0;
+void handle_message(Client *client, char *line) {
+    if (!client->is_authenticated) {
+        if (authenticate_client(client, line)) {
+            printf("Client %s authenticated\n", client->username);
 
-        if (authenticate_client(client_socket, buffer)) {
-            strcpy(username, buffer);
-            is_authenticated = 1;
-            printf("Client %s authenticated\n", username);
-            
-            send(client_socket, "Authenticated", 13, 0);
+            send_message(client, client, "Authenticated", 13);
         } else {
-            send(client_socket, "Username already taken", 22, 0);
+            send_message(client, client, "Username already taken", 22);
         }
+        return;
     }
 
+    unsigned long allocations_before = heap_allocations;
+    route_message(client, line);
+    pool_stats.messages_routed++;
+    pool_stats.message_path_allocations += heap_allocations - allocations_before;
+}
+
+// one DRR turn: the session earns a quantum of bytes and handles complete
+// messages while the next one fits in its deficit, its per-turn message
+// cap and its tokens allow. anything left waits for the next turn, so one
+// chatty session cannot hold up the others; a session out of tokens is
+// not read at all, which pushes back on that sender through TCP flow
+// control. readable says whether the socket has data waiting
+void serve_client(Client *client, long long now, int readable) {
+    int handled = 0;
+    int reads = 0;
+
+    client->deficit += QUANTUM;
+
     while (1) {
-        memset(buffer, 0, BUFFER_SIZE);
-        int bytes_received = recv(client_socket, buffer, BUFFER_SIZE, 0);
+        size_t length = pending_line_length(client);
 
-        if (bytes_received <= 0) {
-            break;
+        if (length == 0) {
+            // no complete message buffered: read more, a bounded number of times
+            if (!readable || reads == MAX_MESSAGES_PER_TURN) {
+                client->deficit = 0;    // idle sessions do not bank credit
+                return;
+            }
+            reads++;
+            int bytes_received = receive_input(client);
+            if (bytes_received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                readable = 0;
+            } else if (bytes_received <= 0) {
+                disconnect_client(client);
+                return;
+            }
+            continue;
         }
 
-        // Remove newline if present
-        buffer[strcspn(buffer, "\n")] = 0;
+        // only a message too large for this turn's credit carries the credit
+        // over, which is less than one message; when the message cap or the
+        // token bucket ends the turn the credit is not banked
+        if ((long)length > client->deficit) {
+            scheduler_stats.quantum_exhausted++;
+            return;
+        }
+        if (handled == MAX_MESSAGES_PER_TURN) {
+            scheduler_stats.quantum_exhausted++;
+            client->deficit = 0;
+            return;
+        }
 
-        // Check if command is LIST
-        if (strcmp(buffer, "LIST") == 0) {
-            broadcast_online_clients(client_socket);
-        } else {
-            // Parse message format: username:message
-            char *target_username = strtok(buffer, ":");
-            char *message = strtok(NULL, "");
-
-            if (target_username && message) {
-                int target_socket = find_client_by_username(target_username);
-
-                if (target_socket != -1) {
-                    char message_buffer[BUFFER_SIZE];
-                    snprintf(message_buffer, BUFFER_SIZE, "%s: %s", username, message);
-
-                    send(target_socket, message_buffer, strlen(message_buffer), 0);
-                } else {
-                    char error_msg[BUFFER_SIZE];
-                    snprintf(error_msg, BUFFER_SIZE, "User %s not found or not online", target_username);
-                    send(client_socket, error_msg, strlen(error_msg), 0);
-                }
-            } else {
-                send(client_socket, "Invalid message format. Use username:message", 43, 0);
-            }
+        refill_tokens(client, now);
+        if (client->tokens < 1.0) {
+            scheduler_stats.throttled++;
+            client->deficit = 0;
+            return;
         }
+
+        client->tokens -= 1.0;
+        client->deficit -= length;
+        handled++;
+        handle_message(client, take_line(client, length));
     }
+}
+
+void accept_clients(int server_socket) {
+    while (1) {
+        struct sockaddr_in client_address;
+        socklen_t client_length = sizeof(client_address);
 
-    pthread_mutex_lock(&clients_mutex);
-    clients[client_index].is_authenticated = 0;
-    strcpy(clients[client_index].username, "");
-    pthread_mutex_unlock(&clients_mutex);
+        int client_socket = accept(server_socket, (struct sockaddr *)&client_address, &client_length);
 
-    close(client_socket);
-    printf("Client %s disconnected\n", username);
-    return NULL;
+        if (client_socket < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("Error accepting client connection");
+            }
+            return;
+        }
+
+        printf("New connection from %s:%d\n",
+               inet_ntoa(client_address.sin_addr),
+               ntohs(client_address.sin_port));
+
+        // Take a session from the slab
+        Client *client = client_alloc(client_socket);
+        if (!client) {
+            send(client_socket, "Server full\n", 12, MSG_NOSIGNAL);
+            close(client_socket);
+            continue;
+        }
+        set_nonblocking(client_socket);
+
+        // replies are small and latency-bound: without this, Nagle holds
+        // each one back until the reader acknowledges the previous one
+        int nodelay = 1;
+        if (setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+            perror("Error setting TCP_NODELAY");
+        }
+    }
 }
 
 int main() {
     int server_socket = setup_server();
-    pthread_t threads[MAX_CLIENTS];
+    struct pollfd fds[MAX_CLIENTS + 1];
+    Client *polled[MAX_CLIENTS + 1];
+    int next_turn = 0;
 
-    // Initialize client array
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        clients[i].is_authenticated = 0;
-        strcpy(clients[i].username, "");
-    }
+    // Initialize client slab and buffer pool
+    initialize_pools();
+    printf("Session memory: %zu bytes each, %zu bytes for %d clients\n",
+           session_memory(), session_memory() * MAX_CLIENTS, MAX_CLIENTS);
 
     while(1) {
-        struct sockaddr_in client_address;
-        socklen_t client_length = sizeof(client_address);
-
-        int client_socket = accept(server_socket, (struct sockaddr *)&client_address, &client_length);
+        long long now = now_us();
+        long long timeout_us = -1;
+        int nfds = 0;
+
+        fds[nfds].fd = server_socket;
+        fds[nfds].events = POLLIN;
+        polled[nfds++] = NULL;
+
+        // throttled sessions are left out of POLLIN until they earn a token;
+        // sessions with complete messages already buffered need no poll wait,
+        // and sessions with queued output wait for POLLOUT
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            Client *client = &clients[i];
+            if (client->socket < 0) {
+                continue;
+            }
+            refill_tokens(client, now);
+            fds[nfds].fd = client->socket;
+            fds[nfds].events = client->tokens >= 1.0 ? POLLIN : 0;
+            if (client->output_count > 0) {
+                fds[nfds].events |= POLLOUT;
+            }
+            if (client->tokens >= 1.0 && pending_line_length(client) > 0) {
+                timeout_us = 0;
+            } else if (client->tokens < 1.0) {
+                long long delay = throttle_delay(client);
+                if (timeout_us < 0 || delay < timeout_us) {
+                    timeout_us = delay;
+                }
+            }
+            polled[nfds++] = client;
+        }
 
-        if (client_socket < 0) {
-            perror("Error accepting client connection");
+        int timeout_ms = timeout_us < 0 ? -1 : (int)((timeout_us + 999) / 1000);
+        if (poll(fds, nfds, timeout_ms) < 0) {
+            if (errno != EINTR) {
+                perror("Error polling sockets");
+            }
             continue;
         }
 
-        printf("New connection from %s:%d\n", 
-               inet_ntoa(client_address.sin_addr), 
-               ntohs(client_address.sin_port));
+        // serve ready sessions round robin, starting one further along each
+        // pass so no slot is always first in line
+        now = now_us();
+        for (int n = 0; n < nfds - 1; n++) {
+            int index = 1 + (next_turn + n) % (nfds - 1);
+            Client *client = polled[index];
+            int readable = fds[index].revents & POLLIN;
+
+            if (fds[index].revents & POLLERR) {
+                disconnect_client(client);
+                continue;
+            }
+            if (fds[index].revents & POLLOUT) {
+                flush_output(client);
+            }
 
-        // Allocate memory for the socket descriptor
-        int *client_socket_ptr = malloc(sizeof(int));
-        *client_socket_ptr = client_socket;
+            if (readable || (client->tokens >= 1.0 && pending_line_length(client) > 0)) {
+                serve_client(client, now, readable);
+            } else if (fds[index].revents & POLLHUP) {
+                // hung up while throttled: nothing left worth reading
+                disconnect_client(client);
+            }
+        }
+        if (nfds > 1) {
+            next_turn = (next_turn + 1) % (nfds - 1);
+        }
 
-        if (pthread_create(&threads[client_socket % MAX_CLIENTS], NULL, handle_client, client_socket_ptr) != 0) {
-            perror("Error creating thread");
-            free(client_socket_ptr);
-            close(client_socket);
+        if (fds[0].revents & POLLIN) {
+            accept_clients(server_socket);
         }
     }
 